@@ -0,0 +1,142 @@
+#include "animationtimeline.h"
+#include "switchcell.h"
+#include "spriteatlas.h"
+#include <algorithm>
+
+static const qint32 RotationStep = 90;
+static const qint32 FullCircle = 360;
+static const qint64 RotationDuration = 180;
+
+AnimationTimeline::AnimationTimeline()
+{
+	_clock.start();
+}
+
+void AnimationTimeline::reset(qint32 rows, qint32 columns)
+{
+	_rows = rows;
+	_columns = columns;
+	_scheduledAngles.assign(_rows * _columns, -1);
+	_scheduledEnds.assign(_rows * _columns, 0);
+	_scheduledCells.clear();
+	_rotations.clear();
+	_deadline = 0;
+}
+
+void AnimationTimeline::clear(std::vector<qint32>& scheduled)
+{
+	_rotations.clear();
+	for (auto index : _scheduledCells)
+	{
+		_scheduledAngles[index] = -1;
+		_scheduledEnds[index] = 0;
+	}
+	scheduled.insert(scheduled.end(), _scheduledCells.begin(), _scheduledCells.end());
+	_scheduledCells.clear();
+	_deadline = 0;
+}
+
+qint64 AnimationTimeline::remainingTime() const
+{
+	return std::max(_deadline - _clock.elapsed(), qint64(0));
+}
+
+void AnimationTimeline::addRotation(const std::vector<SwitchCell>& cells, qint32 row, 
+									qint32 column, qint32 destRow, qint32 destColumn)
+{
+	const auto now = _clock.elapsed();
+	if (destRow == -1 || destColumn == -1)
+	{
+		auto end = schedule(cells, row, column, now);
+		if (row > 0)
+		{
+			scheduleWave(cells, row - 1, column, 0, column, end);
+		}
+		if (row < _rows - 1)
+		{
+			scheduleWave(cells, row + 1, column, _rows - 1, column, end);
+		}
+		if (column > 0)
+		{
+			scheduleWave(cells, row, column - 1, row, 0, end);
+		}
+		if (column < _columns - 1)
+		{
+			scheduleWave(cells, row, column + 1, row, _columns - 1, end);
+		}
+	}
+	else
+	{
+		scheduleWave(cells, row, column, destRow, destColumn, now);
+	}
+}
+
+bool AnimationTimeline::advance(std::vector<SwitchCell>& cells, std::vector<qint32>& changed)
+{
+	const auto now = _clock.elapsed();
+	size_t kept = 0;
+	for (size_t i = 0; i < _rotations.size(); ++i)
+	{
+		const auto& rotation = _rotations[i];
+		if (now < rotation.start)
+		{
+			_rotations[kept++] = rotation;
+			continue;
+		}
+		const auto elapsed = std::min(now - rotation.start, RotationDuration);
+		// the atlas has a frame per AngleStep, the angle only changes when the frame does
+		auto offset = qint32(elapsed * RotationStep / RotationDuration);
+		offset -= offset % SpriteAtlas::AngleStep;
+		const auto angle = (rotation.angle + offset) % FullCircle;
+		if (cells[rotation.cell].angle() != angle)
+		{
+			cells[rotation.cell].setAngle(angle);
+			changed.push_back(rotation.cell);
+		}
+		if (elapsed < RotationDuration)
+		{
+			_rotations[kept++] = rotation;
+		}
+	}
+	_rotations.resize(kept);
+	return !_rotations.empty();
+}
+
+qint64 AnimationTimeline::schedule(const std::vector<SwitchCell>& cells, qint32 row, 
+								   qint32 column, qint64 start)
+{
+	const auto index = row * _columns + column;
+	// two waves may cross the same switch, the later rotation is queued after the earlier one
+	auto angle = cells[index].angle();
+	if (_scheduledAngles[index] != -1)
+	{
+		angle = _scheduledAngles[index];
+		start = std::max(start, _scheduledEnds[index]);
+	}
+	else
+	{
+		_scheduledCells.push_back(index);
+	}
+	Rotation rotation = { index, angle, start };
+	_rotations.push_back(rotation);
+	const auto end = start + RotationDuration;
+	_scheduledAngles[index] = (angle + RotationStep) % FullCircle;
+	_scheduledEnds[index] = end;
+	_deadline = std::max(_deadline, end);
+	return end;
+}
+
+void AnimationTimeline::scheduleWave(const std::vector<SwitchCell>& cells, qint32 row, 
+									 qint32 column, qint32 destRow, qint32 destColumn, 
+									 qint64 start)
+{
+	const auto rowStep = (destRow > row) - (destRow < row);
+	const auto columnStep = (destColumn > column) - (destColumn < column);
+	start = schedule(cells, row, column, start);
+	while (row != destRow || column != destColumn)
+	{
+		row += (row != destRow) ? rowStep : 0;
+		column += (column != destColumn) ? columnStep : 0;
+		start = schedule(cells, row, column, start);
+	}
+}
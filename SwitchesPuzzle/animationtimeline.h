@@ -0,0 +1,54 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <vector>
+
+class SwitchCell;
+
+// Owns every rotation that is running on the field. The whole wave of a move is scheduled
+// when the move is made: every switch on the way gets its start time, and its angle is
+// computed from the elapsed time alone, so frame drops never stretch the animation.
+class AnimationTimeline
+{
+public:
+	AnimationTimeline();
+	void		reset(qint32 rows, qint32 columns);
+	// Drops every rotation. Indices of the switches that have had rotations since the last
+	// clear are appended to scheduled, they may have been left at any angle.
+	void		clear(std::vector<qint32>& scheduled);
+	bool		isRunning() const { return _clock.elapsed() < _deadline; }
+	// Milliseconds until the last scheduled rotation ends.
+	qint64		remainingTime() const;
+	// A rotation without a destination is a press, it starts the waves towards the four
+	// borders. Otherwise the wave runs from the switch to the destination.
+	void		addRotation(const std::vector<SwitchCell>& cells, qint32 row, qint32 column, 
+							qint32 destRow, qint32 destColumn);
+	// Sets the angles of the rotating switches for the current time. Indices of the switches
+	// whose angle has changed are appended to changed. Returns false once every switch has
+	// reached its final angle.
+	bool		advance(std::vector<SwitchCell>& cells, std::vector<qint32>& changed);
+
+private:
+	struct Rotation
+	{
+		qint32	cell;
+		qint32	angle;
+		qint64	start;
+	};
+
+	std::vector<Rotation>	_rotations;
+	// the angle each switch will have after its last scheduled rotation, -1 for idle switches
+	std::vector<qint32>		_scheduledAngles;
+	std::vector<qint64>		_scheduledEnds;
+	// switches with a scheduled angle, so clearing does not scan the field
+	std::vector<qint32>		_scheduledCells;
+	QElapsedTimer			_clock;
+	qint64					_deadline{ 0 };
+	qint32					_rows{ 0 };
+	qint32					_columns{ 0 };
+
+	qint64		schedule(const std::vector<SwitchCell>& cells, qint32 row, qint32 column, 
+						 qint64 start);
+	void		scheduleWave(const std::vector<SwitchCell>& cells, qint32 row, qint32 column,
+							 qint32 destRow, qint32 destColumn, qint64 start);
+};
@@ -0,0 +1,393 @@
+#include "board.h"
+#include "prng.h"
+#include <QtAlgorithms>
+#include <QMap>
+#include <QPair>
+#include <algorithm>
+
+// Zobrist keys of one board size, for the hash and the check hash. A press changes a hash by
+// the XOR of its row, its column and its own key, since the pressed switch is in both lines
+// but changes once.
+struct ZobristKeys
+{
+	std::vector<quint64> rows[2];
+	std::vector<quint64> columns[2];
+};
+
+// stream 0 gives the keys of hash(), stream 1 those of checkHash()
+static quint64 zobristKey(qint32 row, qint32 column, qint32 stream)
+{
+	const quint64 streamKey = stream == 0 ? 0 : Q_UINT64_C(0xA0761D6478BD642F);
+	quint64 state = ((quint64(row) << 32) | quint32(column)) ^ streamKey;
+	return Prng::splitMix(state);
+}
+
+static const ZobristKeys* zobristKeys(qint32 rows, qint32 columns)
+{
+	static QMap<QPair<qint32, qint32>, ZobristKeys> cache;
+	const auto size = qMakePair(rows, columns);
+	auto iter = cache.find(size);
+	if (iter == cache.end())
+	{
+		ZobristKeys keys;
+		for (qint32 stream = 0; stream < 2; ++stream)
+		{
+			keys.rows[stream].assign(rows, 0);
+			keys.columns[stream].assign(columns, 0);
+			for (qint32 i = 0; i < rows; ++i)
+			{
+				for (qint32 j = 0; j < columns; ++j)
+				{
+					const auto key = zobristKey(i, j, stream);
+					keys.rows[stream][i] ^= key;
+					keys.columns[stream][j] ^= key;
+				}
+			}
+		}
+		iter = cache.insert(size, keys);
+	}
+	return &iter.value();
+}
+
+// Transposes a 64x64 bit block in place, bit j of block[i] being (i, j). Every round swaps
+// the off-diagonal quarters of all blocks of the current size at once.
+static void transposeBlock(Board::Word* block)
+{
+	auto mask = Board::Word(0x00000000FFFFFFFFull);
+	for (qint32 size = 32; size != 0; size >>= 1, mask ^= mask << size)
+	{
+		for (qint32 k = 0; k < Board::WordBits; k = ((k | size) + 1) & ~size)
+		{
+			const auto swapped = ((block[k] >> size) ^ block[k | size]) & mask;
+			block[k] ^= swapped << size;
+			block[k | size] ^= swapped;
+		}
+	}
+}
+
+static Board::Word reverseBits(Board::Word word)
+{
+	word = ((word >> 1) & 0x5555555555555555ull) | ((word & 0x5555555555555555ull) << 1);
+	word = ((word >> 2) & 0x3333333333333333ull) | ((word & 0x3333333333333333ull) << 2);
+	word = ((word >> 4) & 0x0F0F0F0F0F0F0F0Full) | ((word & 0x0F0F0F0F0F0F0F0Full) << 4);
+	word = ((word >> 8) & 0x00FF00FF00FF00FFull) | ((word & 0x00FF00FF00FF00FFull) << 8);
+	word = ((word >> 16) & 0x0000FFFF0000FFFFull) | ((word & 0x0000FFFF0000FFFFull) << 16);
+	return (word >> 32) | (word << 32);
+}
+
+Board::Board(qint32 rows, qint32 columns)
+	: _rows(rows)
+	, _columns(columns)
+	, _wordsPerRow((columns + WordBits - 1) / WordBits)
+{
+	_words.assign(static_cast<size_t>(_rows) * _wordsPerRow, 0);
+	const auto tail = columns % WordBits;
+	_lastWordMask = tail == 0 ? ~Word(0) : (Word(1) << tail) - 1;
+}
+
+bool Board::cell(qint32 row, qint32 column) const
+{
+	return (rowData(row)[column / WordBits] >> (column % WordBits)) & 1;
+}
+
+void Board::setCell(qint32 row, qint32 column, bool value)
+{
+	const auto bit = Word(1) << (column % WordBits);
+	auto& word = _words[row * _wordsPerRow + column / WordBits];
+	if (((word & bit) != 0) != value)
+	{
+		word ^= bit;
+		_count += value ? 1 : -1;
+		if (_keys)
+		{
+			_hash ^= zobristKey(row, column, 0);
+			_checkHash ^= zobristKey(row, column, 1);
+		}
+	}
+}
+
+void Board::fill(bool value)
+{
+	for (qint32 i = 0; i < _rows; ++i)
+	{
+		auto data = &_words[i * _wordsPerRow];
+		for (qint32 j = 0; j < _wordsPerRow; ++j)
+		{
+			data[j] = value ? wordMask(j) : 0;
+		}
+	}
+	_count = value ? _rows * _columns : 0;
+	_countValid = true;
+	_keys = nullptr;
+}
+
+void Board::randomize(Prng& generator)
+{
+	_count = 0;
+	for (qint32 i = 0; i < _rows; ++i)
+	{
+		auto data = &_words[i * _wordsPerRow];
+		for (qint32 j = 0; j < _wordsPerRow; ++j)
+		{
+			data[j] = generator.next() & wordMask(j);
+			_count += qPopulationCount(data[j]);
+		}
+	}
+	_countValid = true;
+	_keys = nullptr;
+}
+
+void Board::toggle(qint32 row, qint32 column)
+{
+	const auto columnWord = column / WordBits;
+	const auto columnShift = column % WordBits;
+	const auto columnBit = Word(1) << columnShift;
+	// every flipped switch moves the count by one, the words are being touched anyway
+	qint32 delta = 0;
+	for (qint32 i = 0; i < _rows; ++i)
+	{
+		auto& word = _words[i * _wordsPerRow + columnWord];
+		word ^= columnBit;
+		delta += qint32((word >> columnShift) & 1);
+	}
+	delta = 2 * delta - _rows;
+	auto data = &_words[row * _wordsPerRow];
+	for (qint32 j = 0; j < _wordsPerRow; ++j)
+	{
+		delta -= qPopulationCount(data[j]);
+		data[j] ^= wordMask(j);
+		delta += qPopulationCount(data[j]);
+	}
+	// the pressed switch belongs to both the row and the column but changes only once
+	data[columnWord] ^= columnBit;
+	delta += (data[columnWord] & columnBit) != 0 ? 1 : -1;
+	_count += delta;
+	hashPress(row, column);
+}
+
+void Board::applyPresses(const Board& presses)
+{
+	Q_ASSERT(presses._rows == _rows && presses._columns == _columns);
+	// moves commute, a switch changes once per press in its row, once per press in its
+	// column and once more if it was pressed itself
+	std::vector<Word> columnParity(_wordsPerRow, 0);
+	for (qint32 i = 0; i < _rows; ++i)
+	{
+		auto source = presses.rowData(i);
+		for (qint32 j = 0; j < _wordsPerRow; ++j)
+		{
+			columnParity[j] ^= source[j];
+		}
+	}
+	_count = 0;
+	for (qint32 i = 0; i < _rows; ++i)
+	{
+		auto source = presses.rowData(i);
+		qint32 rowPresses = 0;
+		for (qint32 j = 0; j < _wordsPerRow; ++j)
+		{
+			rowPresses += qPopulationCount(source[j]);
+		}
+		const auto rowFlip = rowPresses % 2 != 0 ? ~Word(0) : 0;
+		auto data = &_words[i * _wordsPerRow];
+		for (qint32 j = 0; j < _wordsPerRow; ++j)
+		{
+			data[j] ^= source[j] ^ columnParity[j] ^ (rowFlip & wordMask(j));
+			_count += qPopulationCount(data[j]);
+			for (auto word = _keys ? source[j] : 0; word != 0; word &= word - 1)
+			{
+				hashPress(i, j * WordBits + qCountTrailingZeroBits(word));
+			}
+		}
+	}
+	_countValid = true;
+}
+
+bool Board::isSolved() const
+{
+	return count() == _rows * _columns;
+}
+
+qint32 Board::count() const
+{
+	if (!_countValid)
+	{
+		_count = 0;
+		for (auto word : _words)
+		{
+			_count += qPopulationCount(word);
+		}
+		_countValid = true;
+	}
+	return _count;
+}
+
+quint64 Board::hash() const
+{
+	if (!_keys)
+	{
+		_hash = 0;
+		_checkHash = 0;
+		for (qint32 i = 0; i < _rows; ++i)
+		{
+			auto data = rowData(i);
+			for (qint32 j = 0; j < _wordsPerRow; ++j)
+			{
+				for (auto word = data[j]; word != 0; word &= word - 1)
+				{
+					const auto column = j * WordBits + qCountTrailingZeroBits(word);
+					_hash ^= zobristKey(i, column, 0);
+					_checkHash ^= zobristKey(i, column, 1);
+				}
+			}
+		}
+		_keys = zobristKeys(_rows, _columns);
+	}
+	return _hash;
+}
+
+void Board::hashPress(qint32 row, qint32 column)
+{
+	if (_keys)
+	{
+		_hash ^= _keys->rows[0][row] ^ _keys->columns[0][column] ^ zobristKey(row, column, 0);
+		_checkHash ^= _keys->rows[1][row] ^ _keys->columns[1][column] ^ zobristKey(row, column, 1);
+	}
+}
+
+bool Board::firstCell(qint32& row, qint32& column) const
+{
+	for (qint32 i = 0; i < _rows; ++i)
+	{
+		auto data = rowData(i);
+		for (qint32 j = 0; j < _wordsPerRow; ++j)
+		{
+			if (data[j] != 0)
+			{
+				row = i;
+				column = j * WordBits + qCountTrailingZeroBits(data[j]);
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+Board Board::transposed() const
+{
+	Board res(_columns, _rows);
+	Word block[WordBits];
+	for (qint32 rowBlock = 0; rowBlock < res._wordsPerRow; ++rowBlock)
+	{
+		for (qint32 j = 0; j < _wordsPerRow; ++j)
+		{
+			const auto firstRow = rowBlock * WordBits;
+			const auto rows = std::min(qint32(WordBits), _rows - firstRow);
+			std::fill(block + rows, block + WordBits, 0);
+			for (qint32 i = 0; i < rows; ++i)
+			{
+				block[i] = rowData(firstRow + i)[j];
+			}
+			transposeBlock(block);
+			const auto columns = std::min(qint32(WordBits), _columns - j * WordBits);
+			for (qint32 i = 0; i < columns; ++i)
+			{
+				res._words[(j * WordBits + i) * res._wordsPerRow + rowBlock] = block[i];
+			}
+		}
+	}
+	res._count = count();
+	return res;
+}
+
+Board Board::mirrored() const
+{
+	Board res(_rows, _columns);
+	// reversing the words of a row puts column j at bit (wordsPerRow * 64 - 1 - j),
+	// the padding above the last column is then shifted out
+	const auto padding = _wordsPerRow * WordBits - _columns;
+	std::vector<Word> reversed(_wordsPerRow + 1, 0);
+	for (qint32 i = 0; i < _rows; ++i)
+	{
+		auto data = rowData(i);
+		for (qint32 j = 0; j < _wordsPerRow; ++j)
+		{
+			reversed[j] = reverseBits(data[_wordsPerRow - 1 - j]);
+		}
+		auto resData = &res._words[i * _wordsPerRow];
+		for (qint32 j = 0; j < _wordsPerRow; ++j)
+		{
+			resData[j] = padding == 0 ? reversed[j] : 
+						 (reversed[j] >> padding) | (reversed[j + 1] << (WordBits - padding));
+		}
+	}
+	res._count = count();
+	return res;
+}
+
+Board Board::flipped() const
+{
+	Board res(_rows, _columns);
+	for (qint32 i = 0; i < _rows; ++i)
+	{
+		std::copy(rowData(i), rowData(i) + _wordsPerRow, &res._words[(_rows - 1 - i) * _wordsPerRow]);
+	}
+	res._count = count();
+	return res;
+}
+
+Board Board::canonical() const
+{
+	auto res = *this;
+	const auto consider = [&res](const Board& image)
+	{
+		if (image < res)
+		{
+			res = image;
+		}
+	};
+	const auto mirroredBoard = mirrored();
+	consider(mirroredBoard);
+	consider(flipped());
+	consider(mirroredBoard.flipped());
+	if (_rows == _columns)
+	{
+		const auto transposedBoard = transposed();
+		const auto mirroredTransposed = transposedBoard.mirrored();
+		consider(transposedBoard);
+		consider(mirroredTransposed);
+		consider(transposedBoard.flipped());
+		consider(mirroredTransposed.flipped());
+	}
+	return res;
+}
+
+Board::Word Board::wordMask(qint32 word) const
+{
+	return word == _wordsPerRow - 1 ? _lastWordMask : ~Word(0);
+}
+
+bool Board::operator==(const Board& other) const
+{
+	return _rows == other._rows && _columns == other._columns && _words == other._words;
+}
+
+bool Board::operator<(const Board& other) const
+{
+	if (_rows != other._rows || _columns != other._columns)
+	{
+		return _rows != other._rows ? _rows < other._rows : _columns < other._columns;
+	}
+	return std::lexicographical_compare(_words.begin(), _words.end(), other._words.begin(), other._words.end());
+}
+
+Board& Board::operator^=(const Board& other)
+{
+	Q_ASSERT(other._rows == _rows && other._columns == _columns);
+	for (size_t i = 0; i < _words.size(); ++i)
+	{
+		_words[i] ^= other._words[i];
+	}
+	invalidate();
+	return *this;
+}
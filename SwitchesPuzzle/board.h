@@ -0,0 +1,77 @@
+#pragma once
+
+#include <QtGlobal>
+#include <vector>
+
+class Prng;
+struct ZobristKeys;
+
+// Headless model of the puzzle field. Every row is stored as a run of 64-bit words,
+// a set bit means the switch is horizontal. The same layout is used for press masks,
+// where a set bit marks a switch to activate. The number of set bits is kept up to date by
+// every change, so isSolved() and count() do not scan the field. The same holds for the position
+// hash once it has been asked for.
+class Board
+{
+public:
+	typedef quint64 Word;
+	static const qint32 WordBits = 64;
+
+	Board() {}
+	Board(qint32 rows, qint32 columns);
+	qint32		rows() const { return _rows; }
+	qint32		columns() const { return _columns; }
+	qint32		wordsPerRow() const { return _wordsPerRow; }
+	bool		cell(qint32 row, qint32 column) const;
+	void		setCell(qint32 row, qint32 column, bool value);
+	void		fill(bool value);
+	// Sets every switch at random, a whole word of switches per call of the generator.
+	void		randomize(Prng& generator);
+	void		toggle(qint32 row, qint32 column);
+	// Makes every press of the mask in one pass over the field.
+	void		applyPresses(const Board& presses);
+	bool		isSolved() const;
+	qint32		count() const;
+	// 64-bit Zobrist hash of the switches, the XOR of a fixed key per horizontal switch.
+	// A press changes it by a precomputed row key, column key and cell key, so toggle() keeps
+	// it in O(1); changes through the row data make the next call rescan.
+	quint64		hash() const;
+	// A second hash from independent keys, kept along with hash(). Two boards with the same
+	// hash() are told apart by it without comparing the switches.
+	quint64		checkHash() const { hash(); return _checkHash; }
+	bool		firstCell(qint32& row, qint32& column) const;
+	Board		transposed() const;
+	// Columns in reverse order.
+	Board		mirrored() const;
+	// Rows in reverse order.
+	Board		flipped() const;
+	// The smallest of the board's images under the symmetries of its rectangle (8 for a square
+	// board, 4 otherwise). Moves map to moves under all of them and the solved board stays
+	// solved, so boards with the same canonical form are the same puzzle.
+	Board		canonical() const;
+	Word		wordMask(qint32 word) const;
+	const Word*	rowData(qint32 row) const { return &_words[row * _wordsPerRow]; }
+	// Direct writes through the row data are not counted, the next count() rescans once.
+	Word*		rowData(qint32 row) { invalidate(); return &_words[row * _wordsPerRow]; }
+	bool		operator==(const Board& other) const;
+	bool		operator!=(const Board& other) const { return !(*this == other); }
+	// Orders by size, then row by row from the first word.
+	bool		operator<(const Board& other) const;
+	Board&		operator^=(const Board& other);
+
+private:
+	std::vector<Word>	_words;
+	qint32				_rows{ 0 };
+	qint32				_columns{ 0 };
+	qint32				_wordsPerRow{ 0 };
+	Word				_lastWordMask{ 0 };
+	mutable qint32		_count{ 0 };
+	mutable bool		_countValid{ true };
+	mutable quint64		_hash{ 0 };
+	mutable quint64		_checkHash{ 0 };
+	mutable const ZobristKeys* _keys{ nullptr };
+
+	void		invalidate() { _countValid = false; _keys = nullptr; }
+	// Adds the change of a press at (row, column) to the hash, if it is being kept.
+	void		hashPress(qint32 row, qint32 column);
+};
@@ -0,0 +1,214 @@
+#include "boardfile.h"
+#include "board.h"
+#include "mappedfile.h"
+#include <QFile>
+#include <QtEndian>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+
+static const char Magic[4] = { 'S', 'W', 'P', 'Z' };
+static const qint64 ChunkSize = 1 << 16;
+static const QString InvalidError("Input data is invalid");
+static const QString PositionError("Line %1, column %2: %3");
+static const QString CharacterError("unexpected character");
+static const QString WidthError("the row is %1 switches wide, the first row has %2");
+static const QString SizeError("the board is too large");
+static const QString EmptyError("Input data is empty");
+
+QByteArray BoardFile::encode(const Board& board)
+{
+	const auto rowSize = board.wordsPerRow() * qint32(sizeof(Board::Word));
+	QByteArray res(HeaderSize + rowSize * board.rows(), 0);
+	auto data = reinterpret_cast<uchar*>(res.data());
+	memcpy(data, Magic, sizeof(Magic));
+	qToLittleEndian<quint16>(Version, data + 4);
+	qToLittleEndian<quint32>(board.rows(), data + 8);
+	qToLittleEndian<quint32>(board.columns(), data + 12);
+	data += HeaderSize;
+	for (qint32 i = 0; i < board.rows(); ++i)
+	{
+		auto row = board.rowData(i);
+		for (qint32 j = 0; j < board.wordsPerRow(); ++j, data += sizeof(Board::Word))
+		{
+			qToLittleEndian<quint64>(row[j], data);
+		}
+	}
+	return res;
+}
+
+bool BoardFile::load(const QString& filePath, Board& board, QString& error)
+{
+	QFile file(filePath);
+	if (!file.open(QIODevice::ReadOnly))
+	{
+		error = MappedFile::OpenError;
+		return false;
+	}
+	const auto size = file.size();
+	if (size >= HeaderSize)
+	{
+		auto data = file.map(0, size);
+		if (data && isBinary(data, size))
+		{
+			const auto res = loadBinary(data, size, board, error);
+			file.unmap(data);
+			return res;
+		}
+		if (data)
+		{
+			file.unmap(data);
+		}
+	}
+	return importText(file, board, error);
+}
+
+bool BoardFile::decode(const uchar* data, qint64 size, Board& board, QString& error)
+{
+	if (!isBinary(data, size))
+	{
+		error = InvalidError;
+		return false;
+	}
+	return loadBinary(data, size, board, error);
+}
+
+bool BoardFile::isBinary(const uchar* data, qint64 size)
+{
+	return size >= HeaderSize && memcmp(data, Magic, sizeof(Magic)) == 0;
+}
+
+bool BoardFile::loadBinary(const uchar* data, qint64 size, Board& board, QString& error)
+{
+	if (qFromLittleEndian<quint16>(data + 4) > Version)
+	{
+		error = MappedFile::VersionError;
+		return false;
+	}
+	const auto rows = qFromLittleEndian<quint32>(data + 8);
+	const auto columns = qFromLittleEndian<quint32>(data + 12);
+	// the size is checked before the board is allocated, a header alone can claim any size
+	const auto rowSize = (qint64(columns) + Board::WordBits - 1) / Board::WordBits * qint64(sizeof(Board::Word));
+	if (rows == 0 || columns == 0 || rows > quint32(MaxSide) || columns > quint32(MaxSide) ||
+		qint64(rows) * columns > MaxCells || size != HeaderSize + rowSize * rows)
+	{
+		error = InvalidError;
+		return false;
+	}
+	Board res(rows, columns);
+	decodeRows(data + HeaderSize, res);
+	board = res;
+	return true;
+}
+
+void BoardFile::decodeRows(const uchar* data, Board& board)
+{
+	for (qint32 i = 0; i < board.rows(); ++i)
+	{
+		auto row = board.rowData(i);
+		for (qint32 j = 0; j < board.wordsPerRow(); ++j, data += sizeof(Board::Word))
+		{
+			// bits past the last column are not part of the board
+			row[j] = qFromLittleEndian<quint64>(data) & board.wordMask(j);
+		}
+	}
+}
+
+bool BoardFile::importText(QIODevice& input, Board& board, QString& error)
+{
+	// rows are packed into words as they are read, the width is known after the first row
+	std::vector<Board::Word> words;
+	std::vector<Board::Word> row;
+	qint32 width = -1;
+	qint32 column = 0;
+	qint32 rows = 0;
+	qint64 line = 1;
+	qint64 position = 0;
+	auto fail = [&error, &line, &position](const QString& message) -> bool
+	{
+		error = PositionError.arg(line).arg(position).arg(message);
+		return false;
+	};
+	auto endRow = [&]() -> bool
+	{
+		if (column == 0)
+		{
+			return true;
+		}
+		if (width == -1)
+		{
+			width = column;
+		}
+		if (column != width)
+		{
+			return fail(WidthError.arg(column).arg(width));
+		}
+		if (++rows > MaxSide || qint64(rows) * width > MaxCells)
+		{
+			return fail(SizeError);
+		}
+		words.insert(words.end(), row.begin(), row.end());
+		row.assign(row.size(), 0);
+		column = 0;
+		return true;
+	};
+	input.seek(0);
+	QByteArray chunk;
+	while (!(chunk = input.read(ChunkSize)).isEmpty())
+	{
+		for (auto c : chunk)
+		{
+			if (c == '\0')
+			{
+				continue;
+			}
+			++position;
+			if (c == '0' || c == '1')
+			{
+				if (column == MaxSide || (width != -1 && column == width))
+				{
+					return fail(column == MaxSide ? SizeError : WidthError.arg(column + 1).arg(width));
+				}
+				if (column % Board::WordBits == 0 && column / Board::WordBits == qint32(row.size()))
+				{
+					row.push_back(0);
+				}
+				row[column / Board::WordBits] |= Board::Word(c == '1') << (column % Board::WordBits);
+				++column;
+			}
+			else if (c == ' ' || c == '\t' || c == '\r' || c == '\n')
+			{
+				if (!endRow())
+				{
+					return false;
+				}
+				if (c == '\n')
+				{
+					++line;
+					position = 0;
+				}
+			}
+			else
+			{
+				return fail(CharacterError);
+			}
+		}
+	}
+	if (!endRow())
+	{
+		return false;
+	}
+	if (rows == 0)
+	{
+		error = EmptyError;
+		return false;
+	}
+	Board res(rows, width);
+	auto source = words.begin();
+	for (qint32 i = 0; i < rows; ++i, source += res.wordsPerRow())
+	{
+		std::copy(source, source + res.wordsPerRow(), res.rowData(i));
+	}
+	board = res;
+	return true;
+}
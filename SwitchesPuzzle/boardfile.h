@@ -0,0 +1,39 @@
+#pragma once
+
+#include <QString>
+#include <QByteArray>
+
+class Board;
+class QIODevice;
+
+// Reads and writes board configurations.
+// The binary format is little-endian: the "SWPZ" magic, a 16-bit version, 16 reserved bits,
+// 32-bit row and column counts, then every row as whole 64-bit words, exactly the layout of
+// Board, so loading is a single pass over a memory map that copies the words into the board.
+// Text files are imported with a streaming parser: rows of '0'/'1' separated by whitespace,
+// either plain ASCII or the old UTF-16 format (its zero high bytes are skipped). Parsing stops
+// at the first error, which is reported with its line and column.
+class BoardFile
+{
+public:
+	static const quint16 Version = 1;
+	static const qint32 HeaderSize = 16;
+	static const qint32 MaxSide = 65535;
+	// Boards, their counts and the switch widgets index cells with qint32, so the total is
+	// capped as well as each side.
+	static const qint32 MaxCells = 1 << 26;
+
+	// The binary file content of the board.
+	static QByteArray encode(const Board& board);
+	static bool		load(const QString& filePath, Board& board, QString& error);
+	// Reads binary content made by encode().
+	static bool		decode(const uchar* data, qint64 size, Board& board, QString& error);
+	// Fills the rows of the board from little-endian words laid out as in the binary format,
+	// the data must hold rows() * wordsPerRow() words.
+	static void		decodeRows(const uchar* data, Board& board);
+
+private:
+	static bool		isBinary(const uchar* data, qint64 size);
+	static bool		loadBinary(const uchar* data, qint64 size, Board& board, QString& error);
+	static bool		importText(QIODevice& input, Board& board, QString& error);
+};
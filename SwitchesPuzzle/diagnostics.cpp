@@ -0,0 +1,236 @@
+#include "diagnostics.h"
+#include "spriteatlas.h"
+#include "board.h"
+#include "boardfile.h"
+#include "puzzlepack.h"
+#include "distancetable.h"
+#include "solver.h"
+#include <QFileInfo>
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QImage>
+#include <QPainter>
+#include <QTextStream>
+#include <algorithm>
+#include <random>
+#include <set>
+
+static const QString PaintBenchmarkOption("--benchmark-paint");
+static const qint32 DefaultBenchmarkSize = 10;
+static const qint32 BenchmarkFrames = 200;
+static const qint32 BenchmarkSpacing = 15;
+static const QString BoardStressOption("--stress-board");
+static const qint32 StressSize = 1000;
+static const qint32 StressMoves = 1000000;
+static const qint32 StressCheckInterval = 10000;
+static const QString MakePackOption("--make-pack");
+static const QString DuplicateText("the same puzzle as an earlier board, skipped");
+static const QString MakeDistanceTableOption("--make-distance-table");
+
+bool Diagnostics::run(const QStringList& arguments, int& exitCode)
+{
+	const auto paint = arguments.indexOf(PaintBenchmarkOption);
+	if (paint != -1)
+	{
+		exitCode = paintBenchmark(arguments.mid(paint + 1));
+		return true;
+	}
+	if (arguments.contains(BoardStressOption))
+	{
+		exitCode = boardStressTest();
+		return true;
+	}
+	const auto makePack = arguments.indexOf(MakePackOption);
+	if (makePack != -1)
+	{
+		exitCode = makePuzzlePack(arguments.mid(makePack + 1));
+		return true;
+	}
+	const auto makeDistanceTable = arguments.indexOf(MakeDistanceTableOption);
+	if (makeDistanceTable != -1)
+	{
+		exitCode = makeDistanceTable(arguments.mid(makeDistanceTable + 1));
+		return true;
+	}
+	return false;
+}
+
+// Paints a size x size board (10x10 by default) with every switch at a different angle,
+// once through QPainter::rotate() and once from the pre-rotated atlas.
+int Diagnostics::paintBenchmark(const QStringList& arguments)
+{
+	bool validSize = false;
+	auto boardSize = arguments.value(0).toInt(&validSize);
+	if (!validSize || boardSize <= 0)
+	{
+		boardSize = DefaultBenchmarkSize;
+	}
+	const auto cellSize = SpriteAtlas::frameSize();
+	const auto step = QPoint(cellSize.width() + BenchmarkSpacing, cellSize.height() + BenchmarkSpacing);
+	QImage image(boardSize * step.x(), boardSize * step.y(), 
+				 QImage::Format_ARGB32_Premultiplied);
+	const auto& atlas = SpriteAtlas::forRatio(1);
+	QElapsedTimer timer;
+	qint64 elapsed[2] = { 0, 0 };
+	for (qint32 method = 0; method < 2; ++method)
+	{
+		timer.start();
+		for (qint32 frame = 0; frame < BenchmarkFrames; ++frame)
+		{
+			image.fill(Qt::transparent);
+			QPainter painter(&image);
+			for (qint32 i = 0; i < boardSize; ++i)
+			{
+				for (qint32 j = 0; j < boardSize; ++j)
+				{
+					const auto angle = ((frame + i * boardSize + j) % SpriteAtlas::FrameCount) * 
+									   SpriteAtlas::AngleStep;
+					const QPoint topLeft(j * step.x(), i * step.y());
+					if (method == 0)
+					{
+						SpriteAtlas::paintRotated(painter, topLeft, angle);
+					}
+					else
+					{
+						painter.drawPixmap(topLeft, atlas.frame(angle));
+					}
+				}
+			}
+		}
+		elapsed[method] = timer.nsecsElapsed();
+	}
+	QTextStream out(stdout);
+	out << QString("%1x%1 board, %2 frames\n").arg(boardSize).arg(BenchmarkFrames);
+	out << QString("rotate():     %1 us per frame\n").arg(elapsed[0] / 1000.0 / BenchmarkFrames);
+	out << QString("sprite atlas: %1 us per frame\n").arg(elapsed[1] / 1000.0 / BenchmarkFrames);
+	out << QString("speedup:      %1x\n").arg(double(elapsed[0]) / std::max<qint64>(elapsed[1], 1));
+	return 0;
+}
+
+static qint32 scanHorizontal(const Board& board)
+{
+	qint32 res = 0;
+	for (qint32 i = 0; i < board.rows(); ++i)
+	{
+		for (qint32 j = 0; j < board.columns(); ++j)
+		{
+			res += board.cell(i, j) ? 1 : 0;
+		}
+	}
+	return res;
+}
+
+// Applies a million random moves to a 1000x1000 board and checks the maintained count
+// of horizontal switches against a full scan of the field.
+int Diagnostics::boardStressTest()
+{
+	QTextStream out(stdout);
+	std::mt19937 generator(StressSize);
+	Board board(StressSize, StressSize);
+	for (qint32 i = 0; i < StressSize; ++i)
+	{
+		for (qint32 j = 0; j < StressSize; ++j)
+		{
+			board.setCell(i, j, generator() % 2 != 0);
+		}
+	}
+	QElapsedTimer timer;
+	timer.start();
+	for (qint32 move = 1; move <= StressMoves; ++move)
+	{
+		board.toggle(generator() % StressSize, generator() % StressSize);
+		if (move % StressCheckInterval == 0)
+		{
+			const auto expected = scanHorizontal(board);
+			if (board.count() != expected || board.isSolved() != (expected == StressSize * StressSize))
+			{
+				out << QString("move %1: count %2, scan %3\n").arg(move).arg(board.count()).arg(expected);
+				return 1;
+			}
+		}
+	}
+	out << QString("%1 moves on %2x%2 board checked in %3 ms\n").arg(StressMoves).arg(StressSize)
+		.arg(timer.elapsed());
+	return 0;
+}
+
+// --make-pack <pack> <board files...>: writes the boards into a puzzle pack, with their
+// file names as the source and the minimal move count taken from the distance table of the size,
+// or from the solver when there is none. A board that is a rotated or mirrored copy of an earlier
+// one is left out.
+int Diagnostics::makePuzzlePack(const QStringList& arguments)
+{
+	QTextStream out(stdout);
+	if (arguments.size() < 2)
+	{
+		out << MakePackOption << " <pack> <board files...>\n";
+		return 1;
+	}
+	std::vector<PuzzlePack::Entry> entries;
+	std::set<Board> canonicalBoards;
+	QString error;
+	for (qint32 i = 1; i < arguments.size(); ++i)
+	{
+		PuzzlePack::Entry entry;
+		if (!BoardFile::load(arguments[i], entry.board, error))
+		{
+			out << arguments[i] << ": " << error << "\n";
+			return 1;
+		}
+		if (!canonicalBoards.insert(entry.board.canonical()).second)
+		{
+			out << arguments[i] << ": " << DuplicateText << "\n";
+			continue;
+		}
+		Board presses;
+		auto distances = DistanceTable::forSize(entry.board.rows(), entry.board.columns());
+		if (distances)
+		{
+			entry.minimalPresses = distances->distance(entry.board);
+		}
+		else if (Solver::solve(entry.board, presses))
+		{
+			entry.minimalPresses = presses.count();
+		}
+		entry.source = QFileInfo(arguments[i]).fileName();
+		entries.push_back(entry);
+	}
+	if (!PuzzlePack::save(arguments.first(), entries, error))
+	{
+		out << arguments.first() << ": " << error << "\n";
+		return 1;
+	}
+	out << QString("%1 boards written to %2\n").arg(qint32(entries.size())).arg(arguments.first());
+	return 0;
+}
+
+// --make-distance-table <rows> <columns> [file]: searches every state of the size and writes
+// the table, by default next to the executable where the game looks for it.
+int Diagnostics::makeDistanceTable(const QStringList& arguments)
+{
+	QTextStream out(stdout);
+	const auto rows = arguments.value(0).toInt();
+	const auto columns = arguments.value(1).toInt();
+	if (rows <= 0 || columns <= 0)
+	{
+		out << MakeDistanceTableOption << " <rows> <columns> [file]\n";
+		return 1;
+	}
+	auto filePath = arguments.value(2);
+	if (filePath.isEmpty())
+	{
+		filePath = QDir(QCoreApplication::applicationDirPath()).filePath(DistanceTable::fileName(rows, columns));
+	}
+	QElapsedTimer timer;
+	timer.start();
+	QString error;
+	if (!DistanceTable::save(filePath, rows, columns, error))
+	{
+		out << filePath << ": " << error << "\n";
+		return 1;
+	}
+	out << QString("%1x%2 table written to %3 in %4 ms\n").arg(rows).arg(columns).arg(filePath)
+		.arg(timer.elapsed());
+	return 0;
+}
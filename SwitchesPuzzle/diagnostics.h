@@ -0,0 +1,17 @@
+#pragma once
+
+#include <QStringList>
+
+// Developer measurements and tools that are run from the command line instead of the game window.
+class Diagnostics
+{
+public:
+	// Returns true if one of the diagnostic options was given, exitCode then has the result.
+	static bool		run(const QStringList& arguments, int& exitCode);
+
+private:
+	static int		paintBenchmark(const QStringList& arguments);
+	static int		boardStressTest();
+	static int		makePuzzlePack(const QStringList& arguments);
+	static int		makeDistanceTable(const QStringList& arguments);
+};
@@ -0,0 +1,220 @@
+#include "distancetable.h"
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QMap>
+#include <QSharedPointer>
+#include <QtEndian>
+#include <algorithm>
+#include <cstring>
+
+static const char Magic[4] = { 'S', 'W', 'D', 'T' };
+static const qint64 HeaderSize = 16;
+static const QString FileNameText("SwitchesPuzzle%1x%2.dist");
+static const QString FormatError("The file is not a distance table");
+static const QString SizeError("Distance tables are limited to %1 switches");
+
+bool DistanceTable::open(const QString& filePath, QString& error)
+{
+	close();
+	if (!_file.open(filePath, Magic, Version, HeaderSize, FormatError, error))
+	{
+		return false;
+	}
+	const auto data = _file.data();
+	const auto size = _file.size();
+	const auto bits = qFromLittleEndian<quint16>(data + 6);
+	const auto rows = qFromLittleEndian<quint32>(data + 8);
+	const auto columns = qFromLittleEndian<quint32>(data + 12);
+	// each side is bounded before the product, so the header can not make it wrap
+	if ((bits != 4 && bits != 8) || rows == 0 || columns == 0 || 
+		rows > quint32(MaxSwitches) || columns > quint32(MaxSwitches) ||
+		rows * columns > quint32(MaxSwitches) ||
+		size < HeaderSize + (qint64(bits) << (rows * columns)) / 8)
+	{
+		error = FormatError;
+		close();
+		return false;
+	}
+	_rows = qint32(rows);
+	_columns = qint32(columns);
+	_bits = bits;
+	_moves = moveMasks(_rows, _columns);
+	return true;
+}
+
+void DistanceTable::close()
+{
+	_file.close();
+	_moves.clear();
+	_rows = 0;
+	_columns = 0;
+	_bits = 0;
+}
+
+qint32 DistanceTable::distance(const Board& board) const
+{
+	Q_ASSERT(board.rows() == _rows && board.columns() == _columns);
+	return entry(index(board));
+}
+
+bool DistanceTable::nextPress(const Board& board, qint32& row, qint32& column) const
+{
+	const auto state = index(board);
+	const auto move = nextMove(state, entry(state));
+	if (move < 0)
+	{
+		return false;
+	}
+	row = move / _columns;
+	column = move % _columns;
+	return true;
+}
+
+bool DistanceTable::solve(const Board& board, Board& presses) const
+{
+	auto state = index(board);
+	auto distance = entry(state);
+	presses = Board(_rows, _columns);
+	for (auto move = nextMove(state, distance); move >= 0; move = nextMove(state, --distance))
+	{
+		presses.setCell(move / _columns, move % _columns, true);
+		state ^= _moves[move];
+	}
+	return distance == 0;
+}
+
+bool DistanceTable::save(const QString& filePath, qint32 rows, qint32 columns, QString& error)
+{
+	if (rows <= 0 || columns <= 0 || rows * columns > MaxSwitches)
+	{
+		error = SizeError.arg(MaxSwitches);
+		return false;
+	}
+	const auto moves = moveMasks(rows, columns);
+	const auto states = quint32(1) << (rows * columns);
+	// the moves undo themselves, so the distance to the solved state is the distance from it
+	std::vector<quint8> distances(states, 0xFF);
+	std::vector<quint32> queue(1, 0);
+	distances[0] = 0;
+	for (size_t head = 0; head < queue.size(); ++head)
+	{
+		const auto state = queue[head];
+		for (auto move : moves)
+		{
+			if (distances[state ^ move] == 0xFF)
+			{
+				distances[state ^ move] = distances[state] + 1;
+				queue.push_back(state ^ move);
+			}
+		}
+	}
+	const auto maxDistance = distances[queue.back()];
+	const quint16 bits = maxDistance < 0xF ? 4 : 8;
+	const quint8 unreachable = quint8((1 << bits) - 1);
+	QByteArray data(HeaderSize + (qint64(bits) << (rows * columns)) / 8, 0);
+	auto bytes = reinterpret_cast<uchar*>(data.data());
+	memcpy(bytes, Magic, sizeof(Magic));
+	qToLittleEndian<quint16>(Version, bytes + 4);
+	qToLittleEndian<quint16>(bits, bytes + 6);
+	qToLittleEndian<quint32>(rows, bytes + 8);
+	qToLittleEndian<quint32>(columns, bytes + 12);
+	bytes += HeaderSize;
+	for (quint32 state = 0; state < states; ++state)
+	{
+		const auto value = std::min(distances[state], unreachable);
+		if (bits == 8)
+		{
+			bytes[state] = value;
+		}
+		else
+		{
+			bytes[state / 2] |= value << (state % 2 * 4);
+		}
+	}
+	QFile file(filePath);
+	if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size())
+	{
+		error = MappedFile::WriteError;
+		return false;
+	}
+	return true;
+}
+
+QString DistanceTable::fileName(qint32 rows, qint32 columns)
+{
+	return FileNameText.arg(rows).arg(columns);
+}
+
+const DistanceTable* DistanceTable::forSize(qint32 rows, qint32 columns)
+{
+	// a missing table is remembered too, so the file is looked up once per size
+	static QMap<QPair<qint32, qint32>, QSharedPointer<DistanceTable>> tables;
+	const auto key = qMakePair(rows, columns);
+	auto iter = tables.find(key);
+	if (iter == tables.end())
+	{
+		QSharedPointer<DistanceTable> table;
+		QString error;
+		if (rows * columns <= MaxSwitches)
+		{
+			table.reset(new DistanceTable);
+			auto filePath = QDir(QCoreApplication::applicationDirPath()).filePath(fileName(rows, columns));
+			if (!table->open(filePath, error) || table->rows() != rows || table->columns() != columns)
+			{
+				table.reset();
+			}
+		}
+		iter = tables.insert(key, table);
+	}
+	return iter.value().data();
+}
+
+quint32 DistanceTable::index(const Board& board) const
+{
+	quint32 res = 0;
+	for (qint32 i = 0; i < _rows; ++i)
+	{
+		res |= quint32(~board.rowData(i)[0] & board.wordMask(0)) << (i * _columns);
+	}
+	return res;
+}
+
+qint32 DistanceTable::entry(quint32 state) const
+{
+	const auto bytes = _file.data() + HeaderSize;
+	const auto value = _bits == 8 ? bytes[state] : (bytes[state / 2] >> (state % 2 * 4)) & 0xF;
+	return value == (1 << _bits) - 1 ? -1 : qint32(value);
+}
+
+qint32 DistanceTable::nextMove(quint32 state, qint32 distance) const
+{
+	for (qint32 k = 0; distance > 0 && k < qint32(_moves.size()); ++k)
+	{
+		if (entry(state ^ _moves[k]) == distance - 1)
+		{
+			return k;
+		}
+	}
+	return -1;
+}
+
+std::vector<quint32> DistanceTable::moveMasks(qint32 rows, qint32 columns)
+{
+	// a press flips its row and its column, the pressed switch once
+	std::vector<quint32> res(rows * columns, 0);
+	const auto rowMask = (quint32(1) << columns) - 1;
+	for (qint32 i = 0; i < rows; ++i)
+	{
+		for (qint32 j = 0; j < columns; ++j)
+		{
+			auto& mask = res[i * columns + j];
+			mask = rowMask << (i * columns);
+			for (qint32 k = 0; k < rows; ++k)
+			{
+				mask |= quint32(1) << (k * columns + j);
+			}
+		}
+	}
+	return res;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <QString>
+#include <vector>
+#include "board.h"
+#include "mappedfile.h"
+
+// Number of presses needed for every state of a small board, found by a breadth-first search
+// over the moves from the solved state and read back through a memory map.
+// Layout (little-endian): a 16-byte header with the "SWDT" magic, a 16-bit version, the bits
+// per state (4, or 8 when a distance does not fit), rows and columns, then one entry per state.
+// Bit (row * columns + column) of a state index is set when that switch is vertical, so the
+// solved board is state 0. The all-ones entry marks a state that can not be solved.
+class DistanceTable
+{
+public:
+	static const quint16 Version = 1;
+	// 2^25 states take 16 MB at 4 bits each
+	static const qint32 MaxSwitches = 25;
+
+	~DistanceTable() { close(); }
+	bool		open(const QString& filePath, QString& error);
+	void		close();
+	bool		isOpen() const { return _file.isOpen(); }
+	qint32		rows() const { return _rows; }
+	qint32		columns() const { return _columns; }
+	// -1 if the board can not be solved
+	qint32		distance(const Board& board) const;
+	// A press that brings the board one step closer to solved.
+	bool		nextPress(const Board& board, qint32& row, qint32& column) const;
+	// A shortest press set, found by following the table down to the solved state.
+	bool		solve(const Board& board, Board& presses) const;
+
+	static bool	save(const QString& filePath, qint32 rows, qint32 columns, QString& error);
+	static QString fileName(qint32 rows, qint32 columns);
+	// The table shipped next to the executable for the size, nullptr if there is none.
+	static const DistanceTable* forSize(qint32 rows, qint32 columns);
+
+private:
+	MappedFile			_file;
+	std::vector<quint32> _moves;
+	qint32				_rows{ 0 };
+	qint32				_columns{ 0 };
+	qint32				_bits{ 0 };
+
+	quint32		index(const Board& board) const;
+	qint32		entry(quint32 state) const;
+	// A move leading from the state to one at distance - 1, -1 if there is none.
+	qint32		nextMove(quint32 state, qint32 distance) const;
+	static std::vector<quint32> moveMasks(qint32 rows, qint32 columns);
+};
@@ -0,0 +1,100 @@
+#include "hintcache.h"
+#include "boardfile.h"
+#include "mappedfile.h"
+#include <QtEndian>
+#include <cstring>
+
+static const char Magic[4] = { 'S', 'W', 'H', 'C' };
+static const qint64 HeaderSize = 16;
+// the hash, the check hash and the size of the encoded solution
+static const qint64 EntryHeaderSize = 20;
+static const QString FormatError("The file is not a hint cache");
+
+HintCache::HintCache()
+	: _entries(DefaultBudget)
+{
+}
+
+bool HintCache::find(const Board& board, Board& presses)
+{
+	const Key key = { board.hash(), board.rows(), board.columns() };
+	const auto entry = _entries.object(key);
+	if (entry && entry->checkHash == board.checkHash())
+	{
+		presses = entry->presses;
+		++_hits;
+		return true;
+	}
+	++_misses;
+	return false;
+}
+
+void HintCache::insert(const Board& board, const Board& presses)
+{
+	const Key key = { board.hash(), board.rows(), board.columns() };
+	Entry entry = { board.checkHash(), presses };
+	_entries.insert(key, new Entry(entry), cost(presses));
+}
+
+QByteArray HintCache::encode() const
+{
+	QByteArray res(HeaderSize, 0);
+	const auto keys = _entries.keys();
+	auto data = reinterpret_cast<uchar*>(res.data());
+	memcpy(data, Magic, sizeof(Magic));
+	qToLittleEndian<quint16>(Version, data + 4);
+	qToLittleEndian<quint32>(keys.size(), data + 8);
+	for (const auto& key : keys)
+	{
+		const auto cached = _entries.object(key);
+		const auto board = BoardFile::encode(cached->presses);
+		QByteArray entry(EntryHeaderSize, 0);
+		qToLittleEndian<quint64>(key.hash, reinterpret_cast<uchar*>(entry.data()));
+		qToLittleEndian<quint64>(cached->checkHash, reinterpret_cast<uchar*>(entry.data()) + 8);
+		qToLittleEndian<quint32>(board.size(), reinterpret_cast<uchar*>(entry.data()) + 16);
+		res += entry;
+		res += board;
+	}
+	return res;
+}
+
+bool HintCache::load(const QString& filePath, QString& error)
+{
+	MappedFile file;
+	if (!file.open(filePath, Magic, Version, HeaderSize, FormatError, error))
+	{
+		return false;
+	}
+	// entries of older versions have no check hash, the cache then starts empty
+	if (file.version() < Version)
+	{
+		return true;
+	}
+	const auto data = file.data();
+	const auto size = file.size();
+	const auto count = qFromLittleEndian<quint32>(data + 8);
+	// entries are read up to the first damaged one, the ones before it are still good
+	qint64 offset = HeaderSize;
+	for (quint32 i = 0; i < count && size - offset >= EntryHeaderSize; ++i)
+	{
+		const auto hash = qFromLittleEndian<quint64>(data + offset);
+		const auto checkHash = qFromLittleEndian<quint64>(data + offset + 8);
+		const auto boardSize = qFromLittleEndian<quint32>(data + offset + 16);
+		offset += EntryHeaderSize;
+		Board presses;
+		if (boardSize > quint64(size - offset) || !BoardFile::decode(data + offset, boardSize, presses, error))
+		{
+			break;
+		}
+		offset += boardSize;
+		const Key key = { hash, presses.rows(), presses.columns() };
+		Entry entry = { checkHash, presses };
+		_entries.insert(key, new Entry(entry), cost(presses));
+	}
+	return true;
+}
+
+qint32 HintCache::cost(const Board& presses)
+{
+	return qint32(sizeof(Entry)) + presses.rows() * presses.wordsPerRow() * qint32(sizeof(Board::Word));
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <QCache>
+#include <QString>
+#include <QByteArray>
+#include "board.h"
+
+// Minimal solutions of odd x odd positions, the only ones the tracker has to search, so a
+// position met again (undo and redo, replayed openings, a board loaded twice) is not solved
+// again. Keyed by the board hash and size, least recently used entries are dropped once the
+// memory budget is spent. Every entry also keeps the board's check hash and a lookup has to
+// match both, so a collision of one hash is only a miss and no lookup touches the switches.
+// Unsolvable positions are not cached.
+class HintCache
+{
+public:
+	struct Key
+	{
+		quint64	hash;
+		qint32	rows;
+		qint32	columns;
+
+		bool	operator==(const Key& other) const 
+		{ 
+			return hash == other.hash && rows == other.rows && columns == other.columns; 
+		}
+	};
+
+	static const quint16 Version = 2;
+	static const qint32 DefaultBudget = 16 * 1024 * 1024;
+
+	HintCache();
+	// The budget is in bytes of stored solutions.
+	void		setBudget(qint32 bytes) { _entries.setMaxCost(bytes); }
+	qint32		budget() const { return _entries.maxCost(); }
+	bool		find(const Board& board, Board& presses);
+	void		insert(const Board& board, const Board& presses);
+	qint32		size() const { return _entries.size(); }
+	qint64		hits() const { return _hits; }
+	qint64		misses() const { return _misses; }
+	// The file content of the cached solutions, read back by load().
+	QByteArray	encode() const;
+	bool		load(const QString& filePath, QString& error);
+
+private:
+	struct Entry
+	{
+		quint64	checkHash;
+		Board	presses;
+	};
+
+	QCache<Key, Entry> _entries;
+	qint64		_hits{ 0 };
+	qint64		_misses{ 0 };
+
+	static qint32 cost(const Board& presses);
+};
+
+inline uint qHash(const HintCache::Key& key, uint seed = 0)
+{
+	return qHash(key.hash, seed) ^ uint(key.rows * 31 + key.columns);
+}
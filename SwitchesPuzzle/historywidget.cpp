@@ -1,16 +1,89 @@
 #include "historywidget.h"
 #include "switchespuzzle.h"
-#include <QUndoStack>
-#include <QUndoView>
+#include "solver.h"
+#include <QListView>
 #include <QHBoxLayout>
+#include <QBrush>
+#include <QPalette>
+#include <algorithm>
+
+static const QString NewGameLabel("New game");
+static const QString StepLabel("Step %1");
+
+HistoryModel::HistoryModel(QObject* parent)
+	: QAbstractListModel(parent)
+{
+}
+
+int HistoryModel::rowCount(const QModelIndex& parent) const
+{
+	return parent.isValid() ? 0 : _history.size() + 1;
+}
+
+QVariant HistoryModel::data(const QModelIndex& index, int role) const
+{
+	if (!index.isValid())
+	{
+		return QVariant();
+	}
+	if (role == Qt::DisplayRole)
+	{
+		return index.row() == 0 ? NewGameLabel : StepLabel.arg(index.row());
+	}
+	if (role == Qt::ForegroundRole && index.row() > _history.position())
+	{
+		// undone moves stay in the list until a new move replaces them
+		return QBrush(QPalette().color(QPalette::Disabled, QPalette::Text));
+	}
+	return QVariant();
+}
+
+void HistoryModel::addMove(qint32 row, qint32 column)
+{
+	const auto position = _history.position();
+	if (position < _history.size())
+	{
+		beginRemoveRows(QModelIndex(), position + 1, _history.size());
+		_history.truncate();
+		endRemoveRows();
+	}
+	beginInsertRows(QModelIndex(), position + 1, position + 1);
+	_history.addMove(row, column);
+	endInsertRows();
+}
+
+void HistoryModel::setPosition(qint32 position)
+{
+	const auto first = std::min(position, _history.position());
+	const auto last = std::max(position, _history.position());
+	_history.setPosition(position);
+	emit dataChanged(index(first), index(last), QVector<int>() << Qt::ForegroundRole);
+}
+
+void HistoryModel::assign(const Board& presses)
+{
+	beginResetModel();
+	_history.assign(presses);
+	endResetModel();
+}
+
+void HistoryModel::clear()
+{
+	beginResetModel();
+	_history.clear();
+	endResetModel();
+}
 
 HistoryWidget::HistoryWidget(QWidget *parent)
 	: QWidget(parent)
 {
-	_stack = new QUndoStack(this);
-	_stack->setUndoLimit(100);
-	_view = new QUndoView(_stack, this);
-	_view->setEmptyLabel("New game");
+	_model = new HistoryModel(this);
+	_view = new QListView(this);
+	// with uniform sizes the view never measures rows it does not show
+	_view->setUniformItemSizes(true);
+	_view->setModel(_model);
+	_view->setEditTriggers(QAbstractItemView::NoEditTriggers);
+	connect(_view, &QListView::clicked, this, &HistoryWidget::jumpTo);
 	auto mainLayout = new QHBoxLayout;
 	mainLayout->addWidget(_view);
 	mainLayout->setContentsMargins(0, 0, 0, 0);
@@ -18,37 +91,72 @@ HistoryWidget::HistoryWidget(QWidget *parent)
 	setWindowTitle("History");
 }
 
-void HistoryWidget::addCommand(SwitchCommand* command)
+void HistoryWidget::addMove(qint32 row, qint32 column)
 {
-	_stack->push(command);
+	_model->addMove(row, column);
+	if (_executor)
+	{
+		_executor->redoSwitchActivation(row, column);
+	}
+	selectPosition();
 }
 
-void HistoryWidget::clear()
+void HistoryWidget::reset(SwitchesPuzzle* puzzle)
 {
-	_stack->clear();
-	SwitchCommand::resetCounter();
+	_executor = puzzle;
+	_model->clear();
+	selectPosition();
 }
 
-qint32 SwitchCommand::commandsCount = 0;
-
-SwitchCommand::SwitchCommand(qint32 row, qint32 column, SwitchesPuzzle* executor)
-	: _executor(executor), _row(row), _column(column)
+void HistoryWidget::optimize()
 {
-	setText("Step " + QString::number(++commandsCount));
+	if (!_executor)
+	{
+		return;
+	}
+	// the board does not change, so nothing is replayed: the parity of the moves is
+	// collected in one pass and reduced by the solver
+	Board presses(_executor->rows(), _executor->columns());
+	const auto& history = _model->history();
+	history.collectPresses(0, history.position(), presses);
+	Solver::reduce(presses);
+	_model->assign(presses);
+	selectPosition();
 }
 
-void SwitchCommand::undo()
+void HistoryWidget::jumpTo(const QModelIndex& index)
 {
-	if (_executor)
+	const auto& history = _model->history();
+	const auto target = index.row();
+	qint32 row = 0;
+	qint32 column = 0;
+	if (!_executor || target == history.position())
+	{
+		return;
+	}
+	if (target == history.position() - 1)
+	{
+		history.move(target, row, column);
+		_executor->undoSwitchActivation(row, column);
+	}
+	else if (target == history.position() + 1)
 	{
-		_executor->undoSwitchActivation(_row, _column);
+		history.move(history.position(), row, column);
+		_executor->redoSwitchActivation(row, column);
 	}
+	else
+	{
+		Board presses(_executor->rows(), _executor->columns());
+		history.collectPresses(history.position(), target, presses);
+		_executor->applyPresses(presses);
+	}
+	_model->setPosition(target);
+	selectPosition();
 }
 
-void SwitchCommand::redo()
+void HistoryWidget::selectPosition()
 {
-	if (_executor)
-	{
-		_executor->redoSwitchActivation(_row, _column);
-	}
+	const auto current = _model->index(_model->history().position());
+	_view->setCurrentIndex(current);
+	_view->scrollTo(current);
 }
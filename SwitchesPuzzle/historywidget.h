@@ -1,34 +1,48 @@
 #pragma once
 #include <QWidget>
-#include <QUndoCommand>
-class QUndoView;
-class QUndoStack;
+#include <QAbstractListModel>
+#include "movehistory.h"
+class QListView;
 class SwitchesPuzzle;
-class SwitchCommand;
 
-class HistoryWidget : public QWidget
+// List model over MoveHistory. Row 0 is the start of the game, row N is the position
+// after N moves. Labels are built only for the rows the view asks for.
+class HistoryModel : public QAbstractListModel
 {
 	Q_OBJECT
 
 public:
-	HistoryWidget(QWidget *parent);
-	void addCommand(SwitchCommand* command);
-	void clear();
+	HistoryModel(QObject* parent);
+	int			rowCount(const QModelIndex& parent = QModelIndex()) const override;
+	QVariant	data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+	const MoveHistory& history() const { return _history; }
+	void		addMove(qint32 row, qint32 column);
+	void		setPosition(qint32 position);
+	void		assign(const Board& presses);
+	void		clear();
 private:
-	QUndoView* _view{ nullptr };
-	QUndoStack* _stack{ nullptr };
+	MoveHistory	_history;
 };
 
-class SwitchCommand : public QUndoCommand
+class HistoryWidget : public QWidget
 {
+	Q_OBJECT
+
 public:
-	SwitchCommand(qint32 row, qint32 column, SwitchesPuzzle* executor);
-	void undo() override;
-	void redo() override;
-	static void resetCounter() { commandsCount = 0; }
+	HistoryWidget(QWidget *parent);
+	// Applies the move to the puzzle and records it.
+	void addMove(qint32 row, qint32 column);
+	void reset(SwitchesPuzzle* puzzle);
+	// Replaces the moves made so far by the shortest list of presses with the same effect.
+	void optimize();
+	// Presses between the start of the game and the current position.
+	qint32 moveCount() const { return _model->history().position(); }
+private slots:
+	void jumpTo(const QModelIndex& index);
 private:
-	qint32 _row;
-	qint32 _column;
+	QListView* _view{ nullptr };
+	HistoryModel* _model{ nullptr };
 	SwitchesPuzzle* _executor{ nullptr };
-	static qint32 commandsCount;
-};
\ No newline at end of file
+
+	void selectPosition();
+};
@@ -1,16 +1,19 @@
 #include "leaderboard.h"
-#include <QSettings>
+#include "persistencewriter.h"
 #include <QVBoxLayout>
 #include <QPushButton>
+#include <QLabel>
 #include <algorithm>
 #include <QHeaderView>
+#include <QFileSystemWatcher>
+#include <QFile>
 
-static const QString SettingsString("Leaderboard%1");
-static const QString FilePath("SwitchesPuzzleLeaders.ini");
+static const QString FilePath("SwitchesPuzzleLeaders.log");
 static const QString TimeHeader("Time");
 static const QString NameHeader("Name");
 static const QString ButtonText("Apply");
 static const QString WindowTitle("Leaderboard %1 x %1");
+static const QString RankText("Your result is #%1 of %2, better than %3% of all results");
 
 static const qint32 NumberOfEntries = 10;
 
@@ -23,18 +26,24 @@ static void sortData(QList<QPair<qint32, QString>>& data)
 	std::sort(data.begin(), data.end(), sortFunc);
 }
 
-Leaderboard::Leaderboard(qint32 size, QWidget *parent)
-	: QDialog(parent), _size(size)
+Leaderboard::Leaderboard(qint32 size, PersistenceWriter* writer, QWidget *parent)
+	: QDialog(parent), _store(FilePath, NumberOfEntries, writer), _size(size)
 {
 	setWindowTitle(WindowTitle.arg(size));
-	loadLeaders(size);
 	initTableWidget();
 	formLayout();
+	// every size is read once in the background, after that the dialog never waits for the disk
+	_loader = new LeaderboardLoader(FilePath, NumberOfEntries, this);
+	connect(_loader, &QThread::finished, this, &Leaderboard::preloadFinished);
+	_watcher = new QFileSystemWatcher(this);
+	connect(_watcher, &QFileSystemWatcher::fileChanged, this, &Leaderboard::fileChanged);
+	connect(writer, &PersistenceWriter::writeFailed, this, &Leaderboard::writeFailed);
+	preload();
 }
 
 Leaderboard::~Leaderboard()
 {
-	saveLeaders();
+	_loader->wait();
 }
 
 bool Leaderboard::isLeader(qint32 time) const
@@ -74,14 +83,98 @@ void Leaderboard::removeResult()
 	_button->setDisabled(true);
 }
 
+void Leaderboard::recordResult(qint32 time)
+{
+	_store.add(_size, time, QString());
+	watchFile();
+	_rankLabel->setText(rankText(time));
+}
+
+QString Leaderboard::rankText(qint32 time)
+{
+	const auto& ranks = _store.ranks(_size);
+	if (ranks.size() == 0)
+	{
+		return QString();
+	}
+	const auto slower = ranks.size() - ranks.countNotGreater(time);
+	return RankText.arg(ranks.countLess(time) + 1).arg(ranks.size())
+				   .arg(100.0 * slower / ranks.size(), 0, 'f', 1);
+}
+
 void Leaderboard::refreshLeaderboard(qint32 size)
 {
+	if (size != _size)
+	{
+		_rankLabel->clear();
+	}
 	_size = size;
 	setWindowTitle(WindowTitle.arg(size));
 	loadLeaders(size);
 	fillTable();
 }
 
+void Leaderboard::preload()
+{
+	if (_loader->isRunning())
+	{
+		_reloadPending = true;
+		return;
+	}
+	_reloadPending = false;
+	_loader->start();
+}
+
+void Leaderboard::preloadFinished()
+{
+	if (_reloadPending)
+	{
+		preload();
+		return;
+	}
+	// if the leaders were needed earlier they have been read synchronously already
+	if (!_store.isLoaded())
+	{
+		_store.assign(_loader->contents());
+	}
+	watchFile();
+	if (_editedRow < 0)
+	{
+		refreshLeaderboard(_size);
+	}
+}
+
+void Leaderboard::fileChanged()
+{
+	// our own appends and compactions keep the store current, only foreign changes reload it
+	watchFile();
+	if (!_store.isCurrent())
+	{
+		_store.invalidate();
+		preload();
+	}
+}
+
+void Leaderboard::writeFailed(const QString& filePath)
+{
+	// the store counted the lost record in the log size, the next append has to start from
+	// what is really on disk
+	if (filePath == FilePath)
+	{
+		_store.invalidate();
+		preload();
+	}
+}
+
+void Leaderboard::watchFile()
+{
+	// a compaction replaces the file, the watcher then loses it and has to be given it again
+	if (_watcher->files().isEmpty() && QFile::exists(FilePath))
+	{
+		_watcher->addPath(FilePath);
+	}
+}
+
 void Leaderboard::applyChanges()
 {
 	while (_data.size() > NumberOfEntries)
@@ -92,10 +185,12 @@ void Leaderboard::applyChanges()
 	_board->closePersistentEditor(item);
 	item->setFlags(item->flags() & ~Qt::ItemIsEditable);
 	_data[_editedRow].second = item->text();
+	_store.add(_size, _data[_editedRow].first, _data[_editedRow].second);
+	watchFile();
+	_rankLabel->setText(rankText(_data[_editedRow].first));
 	_editedRow = -1;
 	_button->hide();
 	_button->setDisabled(true);
-	saveLeaders();
 	accept();
 }
 
@@ -107,12 +202,7 @@ void Leaderboard::initTableWidget()
 	_board->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
 	_board->horizontalHeader()->setSectionResizeMode(TimeColumn, QHeaderView::ResizeToContents);
 	_board->horizontalHeader()->setStretchLastSection(true);
-	const auto minSize = std::min(_data.size(), NumberOfEntries);
-	for (int i = 0; i < minSize; ++i)
-	{
-		setRow(i, _data[i]);
-	}
-	for (int i = minSize; i < NumberOfEntries; ++i)
+	for (int i = 0; i < NumberOfEntries; ++i)
 	{
 		setRow(i, qMakePair(-1, QString()));
 	}
@@ -123,6 +213,8 @@ void Leaderboard::formLayout()
 {
 	auto mainLayoiut = new QVBoxLayout;
 	mainLayoiut->addWidget(_board);
+	_rankLabel = new QLabel(this);
+	mainLayoiut->addWidget(_rankLabel);
 	_button = new QPushButton(ButtonText, this);
 	connect(_button, &QPushButton::pressed, this, &Leaderboard::applyChanges);
 	mainLayoiut->addWidget(_button);
@@ -146,38 +238,9 @@ void Leaderboard::fillTable()
 	}
 }
 
-void Leaderboard::saveLeaders()
-{
-	QSettings settings(FilePath, QSettings::IniFormat);
-	QList<QVariant> leaders;
-	for (auto iter : _data)
-	{
-		leaders.push_back(iter.first);
-		leaders.push_back(iter.second);
-	}
-	settings.setValue(SettingsString.arg(_size), leaders);
-}
-
 void Leaderboard::loadLeaders(qint32 size)
 {
-	_data.clear();
-	QSettings settings(FilePath, QSettings::IniFormat);
-	auto list = settings.value(SettingsString.arg(size), QList<QVariant>()).toList();
-	for (int i = 0; i < list.size(); ++i)
-	{
-		bool b;
-		int time = list[i].toInt(&b);
-		if (b && ++i < list.size())
-		{
-			QString name = list[i].toString();
-			_data.push_back(qMakePair(time, name));
-		}
-		else
-		{
-			break;
-		}
-	}
-	sortData(_data);
+	_data = _store.results(size);
 }
 
 void Leaderboard::setRow(qint32 row, const QPair<qint32, QString> data)
@@ -3,38 +3,55 @@
 #include <QDialog>
 #include <QList>
 #include <QTableWidget>
+#include "leaderboardstore.h"
 
 class QPushButton;
+class QFileSystemWatcher;
+class QLabel;
+class PersistenceWriter;
 
 class Leaderboard : public QDialog
 {
 	Q_OBJECT
 
 public:
-	Leaderboard(qint32 size, QWidget *parent);
+	Leaderboard(qint32 size, PersistenceWriter* writer, QWidget *parent);
 	~Leaderboard();
 	bool			isLeader(qint32 time) const;
 	void			addResult(qint32 time);
 	void			removeResult();
+	// Records a result that did not make the leaderboard, it still counts for ranks.
+	void			recordResult(qint32 time);
+	// Rank and percentile of the time among all results of the current size.
+	QString			rankText(qint32 time);
 
 public slots:
 	void			refreshLeaderboard(qint32 size);
 
 private slots:
 	void			applyChanges();
+	void			preloadFinished();
+	void			fileChanged();
+	void			writeFailed(const QString& filePath);
 
 private:
 	QTableWidget*					_board{ nullptr };
 	QPushButton*					_button{ nullptr };
+	QLabel*							_rankLabel{ nullptr };
 	QList<QPair<qint32, QString>>	_data;
+	LeaderboardStore				_store;
+	LeaderboardLoader*				_loader{ nullptr };
+	QFileSystemWatcher*				_watcher{ nullptr };
+	bool							_reloadPending{ false };
 	qint32							_editedRow{ -1 };
 	qint32							_size{ 4 };
 	
 	void			initTableWidget();
 	void			formLayout();
 	void			fillTable();
-	void			saveLeaders();
 	void			loadLeaders(qint32 size);
+	void			preload();
+	void			watchFile();
 	void			setRow(qint32 row, const QPair<qint32, QString> data);
 	
 	class TimeItem : public QTableWidgetItem
@@ -0,0 +1,232 @@
+#include "leaderboardstore.h"
+#include "persistencewriter.h"
+#include "mappedfile.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QSettings>
+#include <QtEndian>
+#include <algorithm>
+#include <cstring>
+
+static const char Magic[4] = { 'S', 'W', 'L', 'B' };
+static const quint16 Version = 1;
+static const qint64 HeaderSize = 8;
+static const qint64 RecordHeaderSize = 10;
+static const qint32 MaxNameSize = 0xFFFF;
+static const QString IniFilePath("SwitchesPuzzleLeaders.ini");
+static const QString IniKeyPrefix("Leaderboard");
+
+static QByteArray header()
+{
+	QByteArray res(HeaderSize, 0);
+	memcpy(res.data(), Magic, sizeof(Magic));
+	qToLittleEndian<quint16>(Version, reinterpret_cast<uchar*>(res.data()) + 4);
+	return res;
+}
+
+static QByteArray record(qint32 size, const LeaderboardStore::Result& result)
+{
+	const auto name = result.second.toUtf8().left(MaxNameSize);
+	QByteArray res(RecordHeaderSize, 0);
+	auto data = reinterpret_cast<uchar*>(res.data());
+	qToLittleEndian<quint32>(quint32(size), data);
+	qToLittleEndian<quint32>(quint32(result.first), data + 4);
+	qToLittleEndian<quint16>(quint16(name.size()), data + 8);
+	return res + name;
+}
+
+LeaderboardStore::LeaderboardStore(const QString& filePath, qint32 capacity, 
+								   PersistenceWriter* writer)
+	: _filePath(filePath)
+	, _capacity(capacity)
+	, _writer(writer)
+{
+}
+
+const QList<LeaderboardStore::Result>& LeaderboardStore::results(qint32 size)
+{
+	load();
+	return _contents.results[size];
+}
+
+const RankIndex& LeaderboardStore::ranks(qint32 size)
+{
+	load();
+	return _contents.ranks[size];
+}
+
+void LeaderboardStore::add(qint32 size, qint32 time, const QString& name)
+{
+	// a log changed behind our back is read again before anything is appended to it
+	if (!isCurrent())
+	{
+		invalidate();
+	}
+	load();
+	const auto result = qMakePair(time, name);
+	insert(_contents, _capacity, size, result);
+	_contents.ranks[size].insert(time);
+	// a log that could not be read is never cut, the result is kept for this session only
+	if (!_contents.readable)
+	{
+		return;
+	}
+	// the writer cuts a torn record off at this offset, so the new one starts on a boundary
+	const auto offset = std::max(_contents.fileSize, qint64(0));
+	const auto data = (offset == 0 ? header() : QByteArray()) + record(size, result);
+	_writer->append(_filePath, offset, data);
+	_contents.fileSize = offset + data.size();
+}
+
+void LeaderboardStore::assign(const Contents& contents)
+{
+	_contents = contents;
+	_loaded = true;
+	if (_contents.fileSize == -1)
+	{
+		migrate();
+	}
+}
+
+bool LeaderboardStore::isCurrent() const
+{
+	// while our own writes are on the way the file lags behind the store
+	if (_writer->isPending(_filePath))
+	{
+		return true;
+	}
+	QFileInfo info(_filePath);
+	return info.exists() ? info.size() == _contents.fileSize : _contents.fileSize == -1;
+}
+
+LeaderboardStore::Contents LeaderboardStore::read(const QString& filePath, qint32 capacity)
+{
+	Contents res;
+	if (!QFile::exists(filePath))
+	{
+		return res;
+	}
+	// an empty file is a log without records, the first write puts the header in it
+	res.fileSize = QFileInfo(filePath).size();
+	if (res.fileSize == 0)
+	{
+		return res;
+	}
+	MappedFile file;
+	QString error;
+	if (!file.open(filePath, Magic, Version, HeaderSize, QString(), error))
+	{
+		// the size is kept, so the log is read again once someone else changes it
+		res.readable = false;
+		return res;
+	}
+	const auto data = file.data();
+	const auto size = file.size();
+	QMap<qint32, std::vector<qint32>> times;
+	qint64 position = HeaderSize;
+	while (position + RecordHeaderSize <= size)
+	{
+		const auto record = data + position;
+		const auto nameSize = qFromLittleEndian<quint16>(record + 8);
+		if (position + RecordHeaderSize + nameSize > size)
+		{
+			break;
+		}
+		const auto result = qMakePair(qint32(qFromLittleEndian<quint32>(record + 4)), 
+			QString::fromUtf8(reinterpret_cast<const char*>(record + RecordHeaderSize), nameSize));
+		const auto fieldSize = qint32(qFromLittleEndian<quint32>(record));
+		insert(res, capacity, fieldSize, result);
+		times[fieldSize].push_back(result.first);
+		position += RecordHeaderSize + nameSize;
+	}
+	file.close();
+	for (auto iter = times.begin(); iter != times.end(); ++iter)
+	{
+		res.ranks[iter.key()].assign(iter.value());
+	}
+	res.fileSize = position;
+	return res;
+}
+
+void LeaderboardStore::load()
+{
+	if (!_loaded)
+	{
+		assign(read(_filePath, _capacity));
+	}
+}
+
+bool LeaderboardStore::insert(Contents& contents, qint32 capacity, qint32 size, const Result& result)
+{
+	auto& results = contents.results[size];
+	auto position = std::upper_bound(results.begin(), results.end(), result, 
+		[](const Result& a, const Result& b) { return a.first < b.first; });
+	if (position - results.begin() >= capacity)
+	{
+		return false;
+	}
+	results.insert(position, result);
+	if (results.size() > capacity)
+	{
+		results.removeLast();
+	}
+	return true;
+}
+
+void LeaderboardStore::migrate()
+{
+	if (!QFile::exists(IniFilePath))
+	{
+		return;
+	}
+	QSettings settings(IniFilePath, QSettings::IniFormat);
+	for (const auto& key : settings.childKeys())
+	{
+		bool isSize = false;
+		const auto size = key.mid(IniKeyPrefix.size()).toInt(&isSize);
+		if (!key.startsWith(IniKeyPrefix) || !isSize)
+		{
+			continue;
+		}
+		// the ini keeps a flat list of time, name, time, name...
+		const auto list = settings.value(key).toList();
+		for (qint32 i = 0; i + 1 < list.size(); i += 2)
+		{
+			bool isTime = false;
+			const auto time = list[i].toInt(&isTime);
+			if (!isTime)
+			{
+				break;
+			}
+			insert(_contents, _capacity, size, qMakePair(time, list[i + 1].toString()));
+			_contents.ranks[size].insert(time);
+		}
+	}
+	rewrite();
+}
+
+void LeaderboardStore::rewrite()
+{
+	auto data = header();
+	for (auto iter = _contents.results.begin(); iter != _contents.results.end(); ++iter)
+	{
+		for (const auto& result : iter.value())
+		{
+			data += record(iter.key(), result);
+		}
+	}
+	_writer->replace(_filePath, data);
+	_contents.fileSize = data.size();
+}
+
+LeaderboardLoader::LeaderboardLoader(const QString& filePath, qint32 capacity, QObject* parent)
+	: QThread(parent)
+	, _filePath(filePath)
+	, _capacity(capacity)
+{
+}
+
+void LeaderboardLoader::run()
+{
+	_contents = LeaderboardStore::read(_filePath, _capacity);
+}
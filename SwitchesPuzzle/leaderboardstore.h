@@ -0,0 +1,79 @@
+#pragma once
+
+#include <QList>
+#include <QMap>
+#include <QPair>
+#include <QString>
+#include <QThread>
+#include "rankindex.h"
+
+class PersistenceWriter;
+
+// Every result ever recorded per field size, kept in memory after the first load.
+// The file is an append-only log: after a short header every record is one result
+// (field size, time, name, empty for results that did not make the leaderboard).
+// Adding a result posts a single record to the PersistenceWriter. Replaying the log rebuilds the named best
+// results and a rank index over all times. Results of the old QSettings ini file are
+// moved into the log the first time it is created.
+class LeaderboardStore
+{
+public:
+	typedef QPair<qint32, QString> Result;
+
+	// Everything read from the log. It is built without touching the store, so the log
+	// can be read on another thread.
+	struct Contents
+	{
+		QMap<qint32, QList<Result>> results;
+		QMap<qint32, RankIndex> ranks;
+		// size of the log up to the last complete record, -1 if there is no log yet
+		qint64	fileSize{ -1 };
+		// false if the log exists but could not be read (another format, a newer version,
+		// a failed map), nothing is written to it then
+		bool	readable{ true };
+	};
+
+	LeaderboardStore(const QString& filePath, qint32 capacity, PersistenceWriter* writer);
+	bool		isLoaded() const { return _loaded; }
+	// Sorted by time, at most capacity results. Reads the log if it is not loaded yet.
+	const QList<Result>& results(qint32 size);
+	// Times of all results of the size.
+	const RankIndex& ranks(qint32 size);
+	void		add(qint32 size, qint32 time, const QString& name);
+	void		assign(const Contents& contents);
+	void		invalidate() { _loaded = false; }
+	// False if the log has been changed by someone else since it was read or written here.
+	bool		isCurrent() const;
+
+	static Contents read(const QString& filePath, qint32 capacity);
+
+private:
+	QString		_filePath;
+	qint32		_capacity{ 0 };
+	PersistenceWriter* _writer{ nullptr };
+	Contents	_contents;
+	bool		_loaded{ false };
+
+	void		load();
+	void		migrate();
+	// Writes the named results as a new log, this creates the log from the ini results.
+	void		rewrite();
+
+	static bool	insert(Contents& contents, qint32 capacity, qint32 size, const Result& result);
+};
+
+// Reads the leaderboard log on a worker thread, the result is taken after finished().
+class LeaderboardLoader : public QThread
+{
+public:
+	LeaderboardLoader(const QString& filePath, qint32 capacity, QObject* parent);
+	const LeaderboardStore::Contents& contents() const { return _contents; }
+
+protected:
+	void		run() override;
+
+private:
+	QString		_filePath;
+	qint32		_capacity{ 0 };
+	LeaderboardStore::Contents _contents;
+};
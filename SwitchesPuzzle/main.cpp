@@ -1,10 +1,48 @@
 #include "mainwindow.h"
+#include "diagnostics.h"
 #include <QtWidgets/QApplication>
+#include <QCommandLineParser>
 
 int main(int argc, char *argv[])
 {
 	QApplication a(argc, argv);
-	MainWindow w;
+	int exitCode = 0;
+	if (Diagnostics::run(a.arguments(), exitCode))
+	{
+		return exitCode;
+	}
+	QCommandLineParser parser;
+	QCommandLineOption seedOption("seed", "Seed of the first random board.", "seed");
+	parser.addOption(seedOption);
+	QCommandLineOption sizeOption("size", "Field size of the first board.", "size");
+	parser.addOption(sizeOption);
+	const auto difficulties = MainWindow::difficultyNames();
+	QCommandLineOption difficultyOption("difficulty", "Difficulty of the first board: " + 
+										difficulties.join(", ") + ".", "difficulty");
+	parser.addOption(difficultyOption);
+	QCommandLineOption hintCacheOption("hint-cache-size", "Memory budget of the hint cache in MB.", "MB");
+	parser.addOption(hintCacheOption);
+	QCommandLineOption persistHintsOption("persist-hints", "Keep the hint cache between runs.");
+	parser.addOption(persistHintsOption);
+	parser.parse(a.arguments());
+	MainWindow::StartOptions options;
+	options.size = parser.value(sizeOption).toInt();
+	for (qint32 i = 0; i < difficulties.size(); ++i)
+	{
+		if (difficulties[i].compare(parser.value(difficultyOption), Qt::CaseInsensitive) == 0)
+		{
+			options.difficulty = i;
+		}
+	}
+	options.seed = parser.value(seedOption).toULongLong(&options.seeded);
+	bool validBudget = false;
+	const auto megabytes = parser.value(hintCacheOption).toInt(&validBudget);
+	if (validBudget && megabytes > 0 && megabytes < 2048)
+	{
+		options.hintBudget = megabytes * 1024 * 1024;
+	}
+	options.persistentHints = parser.isSet(persistHintsOption);
+	MainWindow w(options);
 	w.show();
 	return a.exec();
 }
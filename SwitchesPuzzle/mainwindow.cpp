@@ -1,61 +1,192 @@
 #include "mainwindow.h"
 #include "switchespuzzle.h"
 #include "leaderboard.h"
+#include "boardfile.h"
+#include "persistencewriter.h"
+#include "prng.h"
+#include "puzzlegenerator.h"
 #include <QPushButton>
 #include <QSpinBox>
+#include <QComboBox>
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QLabel>
 #include <QMenuBar>
 #include <QDockWidget>
 #include <QTimer>
-#include <QFile>
 #include <QFileDialog>
+#include <QFile>
 #include <QMessageBox>
+#include <QStatusBar>
+#include <QInputDialog>
+#include <QLineEdit>
 #include "historywidget.h"
 
 static const QString NewGameText("New game");
 static const QString WidthText("Width");
 static const QString HeightText("Height");
 static const QString SizeText("Field size");
+static const QString DifficultyText("Difficulty");
+static const QStringList DifficultyNames = QStringList() << "Random" << "Easy" << "Medium" << "Hard";
+// shares of the largest press count the generator can build, per difficulty
+static const qreal DifficultyBands[][2] = { { 0.0, 0.0 }, { 0.1, 0.3 }, { 0.3, 0.6 }, { 0.6, 1.0 } };
+static const QString MinimalPressesText("Solvable in %1 presses");
 static const QString Leaders("Leaderboard");
 static const QString HistoryTitle("History");
 static const QString TimerTitle("Your time: ");
+static const QString SeedText("Seed: %1 (size %2, %3)");
+static const QString StartFromSeedText("Start from seed");
+static const QString SeedPromptText("Seed of a board of the current size and difficulty:");
 static const QString SaveText("Save config");
 static const QString LoadText("Load config");
+static const QString HintText("Hint");
+static const QString SolveText("Solve");
+static const QString OptimizeHistoryText("Optimize history");
+static const QString OpenPackText("Open puzzle pack");
+static const QString GoToPuzzleText("Go to puzzle");
+static const QString PuzzleNumberText("Puzzle number (1-%1):");
+static const QString NoPackText("Open a puzzle pack first");
+static const QString PackPuzzleText("Puzzle %1 of %2");
+static const QString PackSourceText(", %1");
+static const QString PackPressesText(", solvable in %1 presses");
+static const QString WriteErrorText("Can not write %1");
+static const QString UnsolvableText("This configuration can not be solved");
+static const QString PressesLeftText("Presses left: %1");
+static const QString OptimalResultText("Solved in %1 presses, the fewest possible");
+static const QString ExtraPressesText("Solved in %1 presses, %2 more than needed");
+static const QString ResultSeparator(". ");
+static const QString HintCacheText(" (hint cache: %1 hits, %2 misses)");
+static const QString HintCacheFilePath("SwitchesPuzzleHints.cache");
 
-MainWindow::MainWindow(QWidget* parent)
+MainWindow::MainWindow(const StartOptions& options, QWidget* parent)
 : QMainWindow(parent)
 {
 	setWindowIcon(QPixmap(":/SwitchesPuzzle/Resources/icon.png"));
+	// the writer flushes everything posted to it when the window is destroyed
+	_writer = new PersistenceWriter(this);
+	connect(_writer, &PersistenceWriter::writeFailed, this, &MainWindow::showWriteError);
 	initWidgets();
 	formGameOptions();
 	formHistoryDock();
 	_timer = new QTimer(this);
 	_timer->setInterval(10);
 	connect(_timer, &QTimer::timeout, this, &MainWindow::updateTimerLabel);
-	startNewGame();
+	if (options.size > 0)
+	{
+		_fieldSizeSpinBox->setValue(options.size);
+	}
+	_difficultyComboBox->setCurrentIndex(qBound(0, options.difficulty, DifficultyNames.size() - 1));
+	// the first game already looks its hints up, so the cache is set up before it
+	configureHintCache(options.hintBudget, options.persistentHints);
+	startSeededGame(options.seeded ? options.seed : Prng::randomSeed());
+}
+
+MainWindow::~MainWindow()
+{
+	if (_persistentHints)
+	{
+		_writer->replace(HintCacheFilePath, _hints.encode());
+	}
+}
+
+void MainWindow::configureHintCache(qint32 budget, bool persistent)
+{
+	_hints.setBudget(budget);
+	_persistentHints = persistent;
+	QString error;
+	// there is no file before the first run, the cache then starts empty
+	if (persistent && QFile::exists(HintCacheFilePath) && !_hints.load(HintCacheFilePath, error))
+	{
+		QMessageBox::critical(this, "Error", error);
+	}
+}
+
+QStringList MainWindow::difficultyNames()
+{
+	return DifficultyNames;
 }
 
 void MainWindow::startNewGame()
 {
-	initField();
+	startSeededGame(Prng::randomSeed());
+}
+
+void MainWindow::startGameFromSeed()
+{
+	bool accepted = false;
+	const auto text = QInputDialog::getText(this, StartFromSeedText, SeedPromptText, 
+											QLineEdit::Normal, QString(), &accepted);
+	bool validSeed = false;
+	const auto seed = text.trimmed().toULongLong(&validSeed);
+	if (accepted && validSeed)
+	{
+		startSeededGame(seed);
+	}
+}
+
+void MainWindow::startSeededGame(quint64 seed)
+{
+	_seed = seed;
+	qint32 minimalPresses = -1;
+	if (_difficultyComboBox->currentIndex() == 0)
+	{
+		initField();
+	}
+	else
+	{
+		auto board = generateBoard(seed, minimalPresses);
+		initField(&board);
+	}
 	reset();
+	_seedLabel->setText(SeedText.arg(seed).arg(_fieldSizeSpinBox->value())
+								.arg(_difficultyComboBox->currentText()));
+	if (minimalPresses >= 0)
+	{
+		statusBar()->showMessage(MinimalPressesText.arg(minimalPresses));
+	}
 }
 
-void MainWindow::startGame(const QStringList& config)
+Board MainWindow::generateBoard(quint64 seed, qint32& minimalPresses) const
 {
-	initField(config);
+	auto size = _fieldSizeSpinBox->value();
+	auto maxPresses = PuzzleGenerator::maxPresses(size, size);
+	auto band = DifficultyBands[_difficultyComboBox->currentIndex()];
+	auto low = qMax(1, qRound(band[0] * maxPresses));
+	auto high = qMax(low, qRound(band[1] * maxPresses));
+	Prng generator(seed);
+	auto presses = low + qint32(generator.next() % quint64(high - low + 1));
+	return PuzzleGenerator::generate(size, size, presses, generator, minimalPresses);
+}
+
+void MainWindow::startGame(const Board& board)
+{
+	initField(&board);
 	reset();
+	_seedLabel->clear();
 }
 
 void MainWindow::reset()
 {
-	_history->clear();
+	_history->reset(_puzzle);
 	_history->setEnabled(true);
 	_history->resize(_history->width(), centralWidget()->height());
 	_timer->start();
 	_time.restart();
+	_assisted = false;
+	_minimalPresses = _puzzle->remainingPresses();
+	statusBar()->clearMessage();
+}
+
+QString MainWindow::resultText() const
+{
+	// empty when the board had no known solution
+	if (_minimalPresses < 0)
+	{
+		return QString();
+	}
+	const auto presses = _history->moveCount();
+	return ResultSeparator + (presses <= _minimalPresses ? OptimalResultText.arg(presses) : 
+							  ExtraPressesText.arg(presses).arg(presses - _minimalPresses));
 }
 
 void MainWindow::finishGame()
@@ -64,13 +195,23 @@ void MainWindow::finishGame()
 	_timer->stop();
 	_history->setDisabled(true); 
 	_leaders->refreshLeaderboard(_puzzle->fieldSize());
-	if (_leaders->isLeader(roundTime))
+	if (!_assisted)
 	{
-		_leaders->addResult(roundTime);
-		if (_leaders->exec() != QDialog::Accepted)
+		if (!_leaders->isLeader(roundTime))
 		{
-			_leaders->removeResult();
+			_leaders->recordResult(roundTime);
 		}
+		else
+		{
+			_leaders->addResult(roundTime);
+			if (_leaders->exec() != QDialog::Accepted)
+			{
+				// without a name the result is kept like any other, it still counts for ranks
+				_leaders->removeResult();
+				_leaders->recordResult(roundTime);
+			}
+		}
+		statusBar()->showMessage(_leaders->rankText(roundTime) + resultText());
 	}
 	_leaders->refreshLeaderboard(_fieldSizeSpinBox->value());
 }
@@ -85,103 +226,131 @@ void MainWindow::updateTimerLabel()
 
 void MainWindow::addCommand(qint32 row, qint32 column)
 {
-	auto command = new SwitchCommand(row, column, _puzzle);
-	_history->addCommand(command);
+	_history->addMove(row, column);
 }
 
-void MainWindow::saveConfigToFile(const QString& filePath, const QStringList& config)
+void MainWindow::saveConfig()
 {
-	QFile outputFile(filePath);
-	if (outputFile.open(QIODevice::WriteOnly))
+	auto filePath = QFileDialog::getSaveFileName(this, "Save config");
+	if (!filePath.isEmpty())
 	{
-		QByteArray array;
-		QDataStream output(&array, QIODevice::WriteOnly);
-		for (int i = 0; i < config.size(); ++i)
-		{
-			for (int j = 0; j < config[i].size(); ++j)
-			{
-				output << config[i][j];
-			}
-			output << QChar(' ');
-		}
-		outputFile.write(array);
+		_writer->replace(filePath, BoardFile::encode(_puzzle->board()));
+	}
+}
+
+void MainWindow::showWriteError(const QString& filePath)
+{
+	QMessageBox::critical(this, "Error", WriteErrorText.arg(filePath));
+}
+
+void MainWindow::loadConfig()
+{
+	auto filePath = QFileDialog::getOpenFileName(this);
+	if (filePath.isEmpty())
+	{
+		return;
+	}
+	Board board;
+	QString error;
+	if (BoardFile::load(filePath, board, error))
+	{
+		_fieldSizeSpinBox->setValue(board.rows());
+		startGame(board);
 	}
 	else
 	{
-		QMessageBox::critical(this, "Error", "Can not open the file");
+		QMessageBox::critical(this, "Error", error);
 	}
 }
 
-QStringList MainWindow::loadConfigFromFile(const QString& filePath)
+void MainWindow::showHint()
 {
-	QStringList res;
-	QFile inputFile(filePath);
-	if (inputFile.open(QIODevice::ReadOnly))
+	if (_puzzle->showHint())
+	{
+		statusBar()->showMessage(PressesLeftText.arg(_puzzle->remainingPresses()) + 
+								 HintCacheText.arg(_hints.hits()).arg(_hints.misses()));
+	}
+	else
 	{
-		QByteArray array = inputFile.read(100 * 4);
-		QDataStream input(array);
+		QMessageBox::information(this, HintText, UnsolvableText);
+	}
+}
 
-		while (!input.atEnd())
-		{
-			QChar c;
-			do
-			{
-				input >> c;
-			} while (c != '1' && c != '0');
-			QString row;
-			while (c == '1' || c == '0')
-			{
-				row.push_back(c);
-				input >> c;
-			}
-			res.push_back(row);
-		}
+void MainWindow::solvePuzzle()
+{
+	if (_puzzle->playSolution())
+	{
+		_assisted = true;
 	}
 	else
 	{
-		QMessageBox::critical(this, "Error", "Can not  to load from file");
+		QMessageBox::information(this, SolveText, UnsolvableText);
 	}
-	bool error = res.size() < 4;
-	if (!error)
+}
+
+void MainWindow::optimizeHistory()
+{
+	if (_history->isEnabled())
 	{
-		auto rowSize = res.first().size();
-		for (int i = 1; i < res.size(); ++i)
-		{
-			error = res[i].size() != rowSize;
-			if (error)
-			{
-				break;
-			}
-		}
+		_history->optimize();
 	}
-	if (error)
+}
+
+void MainWindow::openPuzzlePack()
+{
+	auto filePath = QFileDialog::getOpenFileName(this, OpenPackText);
+	if (filePath.isEmpty())
 	{
-		QMessageBox::critical(this, "Error", "Input data is invalid");
+		return;
+	}
+	QString error;
+	if (!_pack.open(filePath, error))
+	{
+		QMessageBox::critical(this, "Error", error);
+	}
+	else if (_pack.size() > 0)
+	{
+		startPackPuzzle(0);
 	}
-	return !error ? res : QStringList();
 }
 
-void MainWindow::saveConfig()
+void MainWindow::goToPuzzle()
 {
-	auto filePath = QFileDialog::getSaveFileName(this, "Save config");
-	if (!filePath.isEmpty())
+	if (!_pack.isOpen() || _pack.size() == 0)
+	{
+		QMessageBox::information(this, GoToPuzzleText, NoPackText);
+		return;
+	}
+	bool accepted = false;
+	auto number = QInputDialog::getInt(this, GoToPuzzleText, PuzzleNumberText.arg(_pack.size()), 
+									   1, 1, _pack.size(), 1, &accepted);
+	if (accepted)
 	{
-		saveConfigToFile(filePath, _puzzle->getConfiguration());
+		startPackPuzzle(number - 1);
 	}
 }
 
-void MainWindow::loadConfig()
+void MainWindow::startPackPuzzle(qint32 index)
 {
-	auto filePath = QFileDialog::getOpenFileName(this);
-	if (!filePath.isEmpty())
+	PuzzlePack::Entry entry;
+	QString error;
+	if (!_pack.entry(index, entry, error))
 	{
-		auto config = loadConfigFromFile(filePath);
-		if (!config.isEmpty())
-		{
-			_fieldSizeSpinBox->setValue(config.size());
-			startGame(config);
-		}
+		QMessageBox::critical(this, "Error", error);
+		return;
+	}
+	_fieldSizeSpinBox->setValue(entry.board.rows());
+	startGame(entry.board);
+	auto text = PackPuzzleText.arg(index + 1).arg(_pack.size());
+	if (!entry.source.isEmpty())
+	{
+		text += PackSourceText.arg(entry.source);
+	}
+	if (entry.minimalPresses >= 0)
+	{
+		text += PackPressesText.arg(entry.minimalPresses);
 	}
+	statusBar()->showMessage(text);
 }
 
 void MainWindow::initWidgets()
@@ -191,33 +360,50 @@ void MainWindow::initWidgets()
 	_fieldSizeSpinBox = new QSpinBox(this);
 	_fieldSizeSpinBox->setRange(4, 10);
 	_fieldSizeSpinBox->setValue(4);
-	_leaders = new Leaderboard(_fieldSizeSpinBox->value(), this);
+	_difficultyComboBox = new QComboBox(this);
+	_difficultyComboBox->addItems(DifficultyNames);
+	_leaders = new Leaderboard(_fieldSizeSpinBox->value(), _writer, this);
 	connect(_fieldSizeSpinBox, SIGNAL(valueChanged(qint32)), _leaders, SLOT(refreshLeaderboard(qint32)));
 	auto menuBar = new QMenuBar(this);
 	auto newGameAct = menuBar->addAction(NewGameText);
+	auto seedGameAct = menuBar->addAction(StartFromSeedText);
 	auto leadersAct = menuBar->addAction(Leaders);
 	auto saveAct = menuBar->addAction(SaveText);
 	auto loadAct = menuBar->addAction(LoadText);
+	auto hintAct = menuBar->addAction(HintText);
+	auto solveAct = menuBar->addAction(SolveText);
+	auto optimizeAct = menuBar->addAction(OptimizeHistoryText);
+	auto openPackAct = menuBar->addAction(OpenPackText);
+	auto goToPuzzleAct = menuBar->addAction(GoToPuzzleText);
 	setMenuBar(menuBar);
 	connect(leadersAct, &QAction::triggered, _leaders, &QDialog::exec);
 	connect(newGameAct, &QAction::triggered, this, &MainWindow::startNewGame);
+	connect(seedGameAct, &QAction::triggered, this, &MainWindow::startGameFromSeed);
 	connect(saveAct, &QAction::triggered, this, &MainWindow::saveConfig);
 	connect(loadAct, &QAction::triggered, this, &MainWindow::loadConfig);
+	connect(hintAct, &QAction::triggered, this, &MainWindow::showHint);
+	connect(solveAct, &QAction::triggered, this, &MainWindow::solvePuzzle);
+	connect(optimizeAct, &QAction::triggered, this, &MainWindow::optimizeHistory);
+	connect(openPackAct, &QAction::triggered, this, &MainWindow::openPuzzlePack);
+	connect(goToPuzzleAct, &QAction::triggered, this, &MainWindow::goToPuzzle);
 	_history = new HistoryWidget(this);
 	_timerLabel = new QLabel(this);
 	_timerLabel->setSizePolicy(QSizePolicy::Minimum, QSizePolicy::Fixed);
+	_seedLabel = new QLabel(this);
+	_seedLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
 }
 
-void MainWindow::initField(const QStringList& config)
+void MainWindow::initField(const Board* board)
 {
 	delete _puzzle;
-	if (config.isEmpty())
+	if (!board)
 	{
-		_puzzle = new SwitchesPuzzle(_fieldSizeSpinBox->value(), _fieldSizeSpinBox->value(), this);
+		_puzzle = new SwitchesPuzzle(_fieldSizeSpinBox->value(), _fieldSizeSpinBox->value(), _seed, 
+									 &_hints, this);
 	}
 	else
 	{
-		_puzzle = new SwitchesPuzzle(config, this);
+		_puzzle = new SwitchesPuzzle(*board, &_hints, this);
 	}
 	connect(_puzzle, &SwitchesPuzzle::completed, this, &MainWindow::finishGame);
 	connect(_puzzle, &SwitchesPuzzle::activated, this, &MainWindow::addCommand);
@@ -232,8 +418,11 @@ void MainWindow::formGameOptions()
 	topLayout->addWidget(_newGamePushButton);
 	topLayout->addWidget(new QLabel(SizeText, widget));
 	topLayout->addWidget(_fieldSizeSpinBox);
+	topLayout->addWidget(new QLabel(DifficultyText, widget));
+	topLayout->addWidget(_difficultyComboBox);
 	topLayout->addWidget(new QLabel(TimerTitle, widget));
 	topLayout->addWidget(_timerLabel);
+	topLayout->addWidget(_seedLabel);
 	topLayout->setAlignment(Qt::AlignLeft);
 	topLayout->setSpacing(5);
 	mainLayout->addItem(topLayout);
@@ -1,47 +1,93 @@
 #pragma once
 #include <QMainWindow>
 #include <QTime>
+#include "puzzlepack.h"
+#include "hintcache.h"
 
 class QPushButton;
 class QSpinBox;
+class QComboBox;
 class SwitchesPuzzle;
 class Leaderboard;
 class HistoryWidget;
 class QLabel;
 class QTimer;
+class Board;
+class PersistenceWriter;
 
 class MainWindow : public QMainWindow
 {
 	Q_OBJECT
 
 public:
-	MainWindow(QWidget* parent = 0);
+	// Difficulty names as they are shown and accepted on the command line.
+	static QStringList difficultyNames();
+
+	// What the first game is made of, taken from the command line.
+	struct StartOptions
+	{
+		// field size, the default one if 0
+		qint32		size{ 0 };
+		// index of the difficulty, 0 is random
+		qint32		difficulty{ 0 };
+		// a random seed is taken unless one is given
+		bool		seeded{ false };
+		quint64		seed{ 0 };
+		// memory budget of the hint cache in bytes
+		qint32		hintBudget{ HintCache::DefaultBudget };
+		// the hint cache is read at start and written back when the window is destroyed
+		bool		persistentHints{ false };
+	};
+
+	explicit MainWindow(const StartOptions& options, QWidget* parent = 0);
+	~MainWindow();
 
 private slots:
 	void			startNewGame();
+	void			startGameFromSeed();
 	void			finishGame();
 	void			updateTimerLabel();
 	void			addCommand(qint32 row, qint32 column);
 	void			saveConfig();
 	void			loadConfig();
+	void			showHint();
+	void			solvePuzzle();
+	void			optimizeHistory();
+	void			openPuzzlePack();
+	void			goToPuzzle();
+	void			showWriteError(const QString& filePath);
 
 private:
 	QPushButton*	_newGamePushButton{ nullptr };
 	QSpinBox*		_fieldSizeSpinBox{ nullptr };
+	QComboBox*		_difficultyComboBox{ nullptr };
 	SwitchesPuzzle* _puzzle{ nullptr };
 	Leaderboard*	_leaders{ nullptr };
 	HistoryWidget*	_history{ nullptr };
+	PersistenceWriter* _writer{ nullptr };
 	QLabel*			_timerLabel{ nullptr };
+	QLabel*			_seedLabel{ nullptr };
 	QTimer*			_timer{ nullptr };
 	QTime			_time;
+	bool			_assisted{ false };
+	quint64			_seed{ 0 };
+	qint32			_minimalPresses{ -1 };
+	PuzzlePack		_pack;
+	HintCache		_hints;
+	bool			_persistentHints{ false };
 
 	void			initWidgets();
-	void			initField(const QStringList& config = QStringList());
+	void			initField(const Board* board = nullptr);
 	void			formGameOptions();
 	void			formHistoryDock();
-	void			startGame(const QStringList& config);
+	void			startGame(const Board& board);
+	// Starts a random game that can be reproduced from the size, the difficulty and the seed.
+	void			startSeededGame(quint64 seed);
+	// Sets the memory budget of the hint cache, a persistent cache is read here.
+	void			configureHintCache(qint32 budget, bool persistent);
+	// Builds a board of the chosen difficulty band from the seed.
+	Board			generateBoard(quint64 seed, qint32& minimalPresses) const;
 	void			reset();
-
-	void			saveConfigToFile(const QString& filePath, const QStringList& config);
-	QStringList		loadConfigFromFile(const QString& filePath);
+	QString			resultText() const;
+	void			startPackPuzzle(qint32 index);
 };
@@ -0,0 +1,49 @@
+#include "mappedfile.h"
+#include <QtEndian>
+#include <cstring>
+
+static const qint32 MagicSize = 4;
+
+const QString MappedFile::OpenError("Can not open the file");
+const QString MappedFile::WriteError("Can not write the file");
+const QString MappedFile::VersionError("The file was saved by a newer version");
+
+bool MappedFile::open(const QString& filePath, const char* magic, quint16 version, qint64 headerSize, 
+					  const QString& formatError, QString& error)
+{
+	close();
+	_file.setFileName(filePath);
+	if (!_file.open(QIODevice::ReadOnly))
+	{
+		error = OpenError;
+		return false;
+	}
+	_size = _file.size();
+	_data = _size >= headerSize && _size >= MagicSize + 2 ? _file.map(0, _size) : nullptr;
+	if (!_data || memcmp(_data, magic, MagicSize) != 0)
+	{
+		error = formatError;
+		close();
+		return false;
+	}
+	_version = qFromLittleEndian<quint16>(_data + MagicSize);
+	if (_version > version)
+	{
+		error = VersionError;
+		close();
+		return false;
+	}
+	return true;
+}
+
+void MappedFile::close()
+{
+	if (_data)
+	{
+		_file.unmap(_data);
+		_data = nullptr;
+	}
+	_file.close();
+	_size = 0;
+	_version = 0;
+}
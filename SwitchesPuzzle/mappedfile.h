@@ -0,0 +1,33 @@
+#pragma once
+
+#include <QFile>
+#include <QString>
+
+// A read-only memory map of one of the binary formats. Every format starts with a 4-byte
+// magic and a 16-bit little-endian version; open() checks both and the minimal header size,
+// so a loader only reads its own fields. The error texts common to the formats live here.
+class MappedFile
+{
+public:
+	static const QString OpenError;
+	static const QString WriteError;
+	static const QString VersionError;
+
+	~MappedFile() { close(); }
+	// Fails with formatError when the file is shorter than the header or has another magic,
+	// and with VersionError when it was saved by a version newer than the given one.
+	bool		open(const QString& filePath, const char* magic, quint16 version, qint64 headerSize, 
+					 const QString& formatError, QString& error);
+	void		close();
+	bool		isOpen() const { return _data != nullptr; }
+	const uchar* data() const { return _data; }
+	qint64		size() const { return _size; }
+	// The version the file was saved with.
+	quint16		version() const { return _version; }
+
+private:
+	QFile		_file;
+	uchar*		_data{ nullptr };
+	qint64		_size{ 0 };
+	quint16		_version{ 0 };
+};
@@ -0,0 +1,60 @@
+#include "movehistory.h"
+#include "board.h"
+#include <QtAlgorithms>
+#include <algorithm>
+
+static const qint32 ColumnBits = 16;
+static const quint32 ColumnMask = (1u << ColumnBits) - 1;
+
+void MoveHistory::clear()
+{
+	_moves.clear();
+	_position = 0;
+}
+
+void MoveHistory::addMove(qint32 row, qint32 column)
+{
+	Q_ASSERT(row >= 0 && column >= 0 && quint32(row) <= ColumnMask && quint32(column) <= ColumnMask);
+	truncate();
+	_moves.push_back((quint32(row) << ColumnBits) | quint32(column));
+	++_position;
+}
+
+void MoveHistory::setPosition(qint32 position)
+{
+	Q_ASSERT(position >= 0 && position <= size());
+	_position = position;
+}
+
+void MoveHistory::move(qint32 index, qint32& row, qint32& column) const
+{
+	row = qint32(_moves[index] >> ColumnBits);
+	column = qint32(_moves[index] & ColumnMask);
+}
+
+void MoveHistory::collectPresses(qint32 from, qint32 to, Board& presses) const
+{
+	qint32 row = 0;
+	qint32 column = 0;
+	for (auto i = std::min(from, to); i < std::max(from, to); ++i)
+	{
+		move(i, row, column);
+		presses.setCell(row, column, !presses.cell(row, column));
+	}
+}
+
+void MoveHistory::assign(const Board& presses)
+{
+	clear();
+	for (qint32 i = 0; i < presses.rows(); ++i)
+	{
+		auto data = presses.rowData(i);
+		for (qint32 j = 0; j < presses.wordsPerRow(); ++j)
+		{
+			for (auto word = data[j]; word != 0; word &= word - 1)
+			{
+				addMove(i, j * Board::WordBits + qCountTrailingZeroBits(word));
+			}
+		}
+	}
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <QtGlobal>
+#include <vector>
+
+class Board;
+
+// Unlimited undo history of a game. Every move is packed into a single 32-bit word
+// (row in the high half, column in the low half) in one contiguous buffer. Moves after
+// the current position are the redo tail, they are dropped by the next new move.
+class MoveHistory
+{
+public:
+	void		clear();
+	void		addMove(qint32 row, qint32 column);
+	// Drops the moves after the current position.
+	void		truncate() { _moves.resize(_position); }
+	qint32		size() const { return qint32(_moves.size()); }
+	qint32		position() const { return _position; }
+	void		setPosition(qint32 position);
+	void		move(qint32 index, qint32& row, qint32& column) const;
+	// Moves commute and undo themselves, so the way between two positions is the parity
+	// of the moves in between. They are XORed into presses.
+	void		collectPresses(qint32 from, qint32 to, Board& presses) const;
+	// Replaces the history by the presses of the mask, in row order, positioned at the end.
+	void		assign(const Board& presses);
+
+private:
+	std::vector<quint32>	_moves;
+	qint32					_position{ 0 };
+};
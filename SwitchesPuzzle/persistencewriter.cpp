@@ -0,0 +1,171 @@
+#include "persistencewriter.h"
+#include <QFile>
+#include <QSaveFile>
+#include <QElapsedTimer>
+
+// a burst of posts shorter than this ends up in a single write
+static const unsigned long CoalesceInterval = 100;
+
+PersistenceWriter::PersistenceWriter(QObject* parent)
+	: QThread(parent)
+{
+	start(QThread::LowPriority);
+}
+
+PersistenceWriter::~PersistenceWriter()
+{
+	flush();
+	{
+		QMutexLocker lock(&_mutex);
+		_stopping = true;
+		_posted.wakeAll();
+	}
+	wait();
+}
+
+void PersistenceWriter::replace(const QString& filePath, const QByteArray& data)
+{
+	Job job = { filePath, data, 0, true };
+	post(job);
+}
+
+void PersistenceWriter::append(const QString& filePath, qint64 offset, const QByteArray& data)
+{
+	Job job = { filePath, data, offset, false };
+	post(job);
+}
+
+bool PersistenceWriter::isPending(const QString& filePath) const
+{
+	QMutexLocker lock(&_mutex);
+	for (const auto& jobs : { &_jobs, &_writing })
+	{
+		for (const auto& job : *jobs)
+		{
+			if (job.filePath == filePath)
+			{
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+void PersistenceWriter::flush()
+{
+	QMutexLocker lock(&_mutex);
+	++_flushes;
+	_posted.wakeAll();
+	while (!_jobs.isEmpty() || !_writing.isEmpty())
+	{
+		_written.wait(&_mutex);
+	}
+	--_flushes;
+}
+
+void PersistenceWriter::run()
+{
+	QMutexLocker lock(&_mutex);
+	while (true)
+	{
+		while (_jobs.isEmpty() && !_stopping)
+		{
+			_posted.wait(&_mutex);
+		}
+		if (_jobs.isEmpty())
+		{
+			break;
+		}
+		// every post wakes the thread, it goes back to sleep until the burst time is over
+		QElapsedTimer burst;
+		burst.start();
+		for (auto left = qint64(CoalesceInterval); left > 0 && !_stopping && _flushes == 0; 
+			 left = qint64(CoalesceInterval) - burst.elapsed())
+		{
+			_posted.wait(&_mutex, static_cast<unsigned long>(left));
+		}
+		_writing.swap(_jobs);
+		lock.unlock();
+		QList<QString> failed;
+		for (const auto& job : _writing)
+		{
+			if (!write(job))
+			{
+				failed.push_back(job.filePath);
+			}
+		}
+		for (const auto& filePath : failed)
+		{
+			emit writeFailed(filePath);
+		}
+		lock.relock();
+		_writing.clear();
+		_written.wakeAll();
+	}
+}
+
+void PersistenceWriter::post(const Job& job)
+{
+	QMutexLocker lock(&_mutex);
+	qint32 last = -1;
+	for (qint32 i = 0; i < _jobs.size(); ++i)
+	{
+		if (_jobs[i].filePath == job.filePath)
+		{
+			last = i;
+		}
+	}
+	if (job.replace)
+	{
+		// the new content makes everything queued for the file obsolete
+		for (qint32 i = _jobs.size() - 1; i >= 0; --i)
+		{
+			if (_jobs[i].filePath == job.filePath)
+			{
+				_jobs.removeAt(i);
+			}
+		}
+		_jobs.push_back(job);
+	}
+	else if (last != -1 && _jobs[last].replace && job.offset == _jobs[last].data.size())
+	{
+		_jobs[last].data += job.data;
+	}
+	else if (last != -1 && !_jobs[last].replace && 
+			 job.offset == _jobs[last].offset + _jobs[last].data.size())
+	{
+		_jobs[last].data += job.data;
+	}
+	else
+	{
+		_jobs.push_back(job);
+	}
+	_posted.wakeAll();
+}
+
+bool PersistenceWriter::write(const Job& job)
+{
+	if (job.replace)
+	{
+		QSaveFile file(job.filePath);
+		return file.open(QIODevice::WriteOnly) && file.write(job.data) == job.data.size() && 
+			   file.commit();
+	}
+	QFile file(job.filePath);
+	if (!file.open(QIODevice::ReadWrite))
+	{
+		return false;
+	}
+	// an earlier append failed or the file was cut by someone else, writing at the offset
+	// would leave a hole of zeros that readers take for records
+	if (file.size() < job.offset)
+	{
+		return false;
+	}
+	// a torn tail that can not be cut would end up in the middle of the log
+	if (file.size() > job.offset && !file.resize(job.offset))
+	{
+		return false;
+	}
+	return file.seek(job.offset) && file.write(job.data) == job.data.size() && file.flush();
+}
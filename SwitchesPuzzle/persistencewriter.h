@@ -0,0 +1,56 @@
+#pragma once
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QList>
+#include <QByteArray>
+#include <QString>
+
+// Writes files on a worker thread, the GUI thread only posts the data.
+// Writes that arrive in a burst are merged while they wait in the queue: a new file
+// content supersedes everything queued for the file, consecutive appends are joined.
+// Whole files are replaced through QSaveFile (temporary file and rename), so a crash
+// leaves either the old or the new content. Appends only ever add a record at the end,
+// a torn tail is cut off by the next append at the same offset. An append past the end of
+// the file fails.
+// Everything posted is on disk when flush() returns and when the writer is destroyed.
+class PersistenceWriter : public QThread
+{
+	Q_OBJECT
+
+public:
+	PersistenceWriter(QObject* parent);
+	~PersistenceWriter();
+	void		replace(const QString& filePath, const QByteArray& data);
+	void		append(const QString& filePath, qint64 offset, const QByteArray& data);
+	// True while something for the file is queued or being written.
+	bool		isPending(const QString& filePath) const;
+	void		flush();
+
+signals:
+	void		writeFailed(const QString& filePath);
+
+protected:
+	void		run() override;
+
+private:
+	struct Job
+	{
+		QString		filePath;
+		QByteArray	data;
+		qint64		offset;
+		bool		replace;
+	};
+
+	mutable QMutex	_mutex;
+	QWaitCondition	_posted;
+	QWaitCondition	_written;
+	QList<Job>		_jobs;
+	QList<Job>		_writing;
+	qint32			_flushes{ 0 };
+	bool			_stopping{ false };
+
+	void		post(const Job& job);
+	static bool	write(const Job& job);
+};
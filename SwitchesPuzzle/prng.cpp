@@ -0,0 +1,42 @@
+#include "prng.h"
+#include <random>
+
+static quint64 rotateLeft(quint64 value, qint32 shift)
+{
+	return (value << shift) | (value >> (64 - shift));
+}
+
+Prng::Prng(quint64 seed)
+{
+	for (auto& word : _state)
+	{
+		word = splitMix(seed);
+	}
+}
+
+quint64 Prng::next()
+{
+	const auto res = rotateLeft(_state[1] * 5, 7) * 9;
+	const auto shifted = _state[1] << 17;
+	_state[2] ^= _state[0];
+	_state[3] ^= _state[1];
+	_state[1] ^= _state[2];
+	_state[0] ^= _state[3];
+	_state[2] ^= shifted;
+	_state[3] = rotateLeft(_state[3], 45);
+	return res;
+}
+
+quint64 Prng::splitMix(quint64& state)
+{
+	auto res = (state += 0x9E3779B97F4A7C15ull);
+	res = (res ^ (res >> 30)) * 0xBF58476D1CE4E5B9ull;
+	res = (res ^ (res >> 27)) * 0x94D049BB133111EBull;
+	return res ^ (res >> 31);
+}
+
+quint64 Prng::randomSeed()
+{
+	std::random_device device;
+	return (quint64(device()) << 32) ^ device();
+}
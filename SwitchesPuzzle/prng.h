@@ -0,0 +1,20 @@
+#pragma once
+
+#include <QtGlobal>
+
+// xoshiro256** generator: fast, 64 bits per call and fully determined by its seed, so any
+// random board can be generated again from the seed. The seed is spread over the state
+// with splitmix64.
+class Prng
+{
+public:
+	explicit Prng(quint64 seed);
+	quint64		next();
+
+	static quint64 splitMix(quint64& state);
+	// A seed taken from the system entropy source.
+	static quint64 randomSeed();
+
+private:
+	quint64		_state[4];
+};
@@ -0,0 +1,81 @@
+#include "puzzlegenerator.h"
+#include "solver.h"
+#include "prng.h"
+#include <algorithm>
+
+qint32 PuzzleGenerator::maxPresses(qint32 rows, qint32 columns)
+{
+	const bool oddRows = rows % 2 != 0;
+	const bool oddColumns = columns % 2 != 0;
+	// an odd number of rows makes full columns flippable in pairs and the other way round
+	const auto columnCap = oddRows ? (rows - 1) / 2 : rows;
+	const auto rowCap = oddColumns ? (columns - 1) / 2 : columns;
+	return std::min(columnCap * columns, rowCap * rows);
+}
+
+Board PuzzleGenerator::generate(qint32 rows, qint32 columns, qint32 presses, Prng& generator,
+								qint32& minimalPresses)
+{
+	presses = qBound(1, presses, std::max(maxPresses(rows, columns), 1));
+	std::vector<qint32> rowOrder(rows);
+	std::vector<qint32> columnOrder(columns);
+	for (qint32 i = 0; i < rows; ++i)
+	{
+		rowOrder[i] = i;
+	}
+	for (qint32 j = 0; j < columns; ++j)
+	{
+		columnOrder[j] = j;
+	}
+	shuffle(rowOrder, generator);
+	shuffle(columnOrder, generator);
+	// the presses are spread evenly over the capped lines: line k of the shuffled order takes
+	// the next presses / lines (or one more) switches starting from switch k, so no line
+	// gets more than its even share
+	const bool byRows = columns % 2 != 0 && rows % 2 == 0;
+	const auto lines = byRows ? rows : columns;
+	const auto length = byRows ? columns : rows;
+	const auto& lineOrder = byRows ? rowOrder : columnOrder;
+	const auto& switchOrder = byRows ? columnOrder : rowOrder;
+	Board pressSet(rows, columns);
+	for (qint32 k = 0; k < lines; ++k)
+	{
+		const auto count = presses / lines + (k < presses % lines ? 1 : 0);
+		for (qint32 s = 0; s < count; ++s)
+		{
+			const auto line = lineOrder[k];
+			const auto position = switchOrder[(k + s) % length];
+			pressSet.setCell(byRows ? line : position, byRows ? position : line, true);
+		}
+	}
+	if (rows % 2 != 0 && columns % 2 != 0)
+	{
+		Solver::reduce(pressSet);
+	}
+	minimalPresses = pressSet.count();
+	Board res(rows, columns);
+	res.fill(true);
+	res.applyPresses(pressSet);
+	return res;
+}
+
+Board PuzzleGenerator::generateRandom(qint32 rows, qint32 columns, Prng& generator)
+{
+	Board presses(rows, columns);
+	Board res(rows, columns);
+	do
+	{
+		presses.randomize(generator);
+		res.fill(true);
+		res.applyPresses(presses);
+	} while (res.isSolved());
+	return res;
+}
+
+void PuzzleGenerator::shuffle(std::vector<qint32>& values, Prng& generator)
+{
+	for (auto i = qint32(values.size()) - 1; i > 0; --i)
+	{
+		std::swap(values[i], values[generator.next() % (i + 1)]);
+	}
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "board.h"
+
+class Prng;
+
+// Builds boards with a known minimal number of presses. A press set is chosen first and
+// the board is the solved board with those presses made, so the board is always solvable
+// and the press set is its solution. The set is kept out of reach of the nullspace
+// (see Solver): per line of a flippable direction it uses fewer switches than half the line,
+// so flipping any even number of such lines only adds presses.
+//  - even x even: every set is the only solution;
+//  - one odd side: lines along the odd side are capped;
+//  - odd x odd: both directions are capped, which does not cover row and column flips made
+//    together, so the set is reduced by the solver afterwards and the result may be lower.
+// The cost is O(rows * columns) for any target.
+class PuzzleGenerator
+{
+public:
+	// The largest press count the construction can produce for the size.
+	static qint32	maxPresses(qint32 rows, qint32 columns);
+	// Returns a board needing presses presses (clamped to [1, maxPresses]), minimalPresses
+	// gets the number of presses of the solution actually built.
+	static Board	generate(qint32 rows, qint32 columns, qint32 presses, Prng& generator, 
+							 qint32& minimalPresses);
+
+	// A board made by a random press set, so every solvable board of the size is equally likely
+	// and no unsolvable one is drawn. A set that leaves the board solved is drawn again.
+	static Board	generateRandom(qint32 rows, qint32 columns, Prng& generator);
+
+private:
+	static void		shuffle(std::vector<qint32>& values, Prng& generator);
+};
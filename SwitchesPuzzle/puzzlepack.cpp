@@ -0,0 +1,115 @@
+#include "puzzlepack.h"
+#include "boardfile.h"
+#include <QFile>
+#include <QtEndian>
+#include <cstring>
+
+static const char Magic[4] = { 'S', 'W', 'P', 'K' };
+static const qint64 HeaderSize = 16;
+static const qint64 IndexEntrySize = 24;
+static const QString FormatError("The file is not a puzzle pack");
+static const QString EntryError("Puzzle %1 is damaged");
+
+bool PuzzlePack::open(const QString& filePath, QString& error)
+{
+	close();
+	if (!_file.open(filePath, Magic, Version, HeaderSize, FormatError, error))
+	{
+		return false;
+	}
+	const auto count = qFromLittleEndian<quint32>(_file.data() + 8);
+	if (count > quint32((_file.size() - HeaderSize) / IndexEntrySize))
+	{
+		error = FormatError;
+		close();
+		return false;
+	}
+	_count = qint32(count);
+	return true;
+}
+
+void PuzzlePack::close()
+{
+	_file.close();
+	_count = 0;
+}
+
+bool PuzzlePack::entry(qint32 index, Entry& entry, QString& error) const
+{
+	Q_ASSERT(index >= 0 && index < _count);
+	const auto indexEntry = _file.data() + HeaderSize + index * IndexEntrySize;
+	const auto offset = qFromLittleEndian<quint64>(indexEntry);
+	const auto rows = qFromLittleEndian<quint32>(indexEntry + 8);
+	const auto columns = qFromLittleEndian<quint32>(indexEntry + 12);
+	const auto minimalPresses = qint32(qFromLittleEndian<quint32>(indexEntry + 16));
+	const auto sourceSize = qFromLittleEndian<quint32>(indexEntry + 20);
+	const auto wordsPerRow = (qint64(columns) + Board::WordBits - 1) / Board::WordBits;
+	const auto boardSize = qint64(rows) * wordsPerRow * sizeof(Board::Word);
+	const auto dataSize = boardSize + sourceSize;
+	if (rows == 0 || columns == 0 || 
+		rows > quint32(BoardFile::MaxSide) || columns > quint32(BoardFile::MaxSide) ||
+		qint64(rows) * columns > BoardFile::MaxCells ||
+		offset > quint64(_file.size()) || quint64(dataSize) > quint64(_file.size()) - offset)
+	{
+		error = EntryError.arg(index + 1);
+		return false;
+	}
+	Board board(rows, columns);
+	const auto boardData = _file.data() + offset;
+	BoardFile::decodeRows(boardData, board);
+	const auto source = boardData + boardSize;
+	entry.board = board;
+	entry.minimalPresses = minimalPresses;
+	entry.source = QString::fromUtf8(reinterpret_cast<const char*>(source), sourceSize);
+	return true;
+}
+
+bool PuzzlePack::save(const QString& filePath, const std::vector<Entry>& entries, QString& error)
+{
+	QFile file(filePath);
+	if (!file.open(QIODevice::WriteOnly))
+	{
+		error = MappedFile::OpenError;
+		return false;
+	}
+	QByteArray header(HeaderSize + IndexEntrySize * entries.size(), 0);
+	auto data = reinterpret_cast<uchar*>(header.data());
+	memcpy(data, Magic, sizeof(Magic));
+	qToLittleEndian<quint16>(Version, data + 4);
+	qToLittleEndian<quint32>(quint32(entries.size()), data + 8);
+	std::vector<QByteArray> sources;
+	auto offset = quint64(header.size());
+	for (size_t i = 0; i < entries.size(); ++i)
+	{
+		const auto& board = entries[i].board;
+		sources.push_back(entries[i].source.toUtf8());
+		auto indexEntry = data + HeaderSize + i * IndexEntrySize;
+		qToLittleEndian<quint64>(offset, indexEntry);
+		qToLittleEndian<quint32>(board.rows(), indexEntry + 8);
+		qToLittleEndian<quint32>(board.columns(), indexEntry + 12);
+		qToLittleEndian<quint32>(quint32(entries[i].minimalPresses), indexEntry + 16);
+		qToLittleEndian<quint32>(sources.back().size(), indexEntry + 20);
+		offset += quint64(board.rows()) * board.wordsPerRow() * sizeof(Board::Word) + sources.back().size();
+	}
+	bool written = file.write(header) == header.size();
+	for (size_t i = 0; written && i < entries.size(); ++i)
+	{
+		const auto& board = entries[i].board;
+		QByteArray words(board.wordsPerRow() * sizeof(Board::Word), 0);
+		for (qint32 row = 0; written && row < board.rows(); ++row)
+		{
+			auto rowData = board.rowData(row);
+			for (qint32 j = 0; j < board.wordsPerRow(); ++j)
+			{
+				qToLittleEndian<quint64>(rowData[j], reinterpret_cast<uchar*>(words.data()) + j * sizeof(Board::Word));
+			}
+			written = file.write(words) == words.size();
+		}
+		written = written && file.write(sources[i]) == sources[i].size();
+	}
+	if (!written)
+	{
+		error = MappedFile::WriteError;
+	}
+	return written;
+}
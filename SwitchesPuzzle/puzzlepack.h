@@ -0,0 +1,39 @@
+#pragma once
+
+#include <QString>
+#include <vector>
+#include "board.h"
+#include "mappedfile.h"
+
+// A file holding many boards of any sizes, read through a memory map.
+// Layout (little-endian): a 16-byte header with the "SWPK" magic, a 16-bit version and the
+// 32-bit entry count, then a fixed-size index entry per board (data offset, rows, columns,
+// minimal presses, source length), then the board words and source names. Entry N is found
+// at a fixed position in the index, so opening the pack and reading one board never touches
+// the other boards.
+class PuzzlePack
+{
+public:
+	struct Entry
+	{
+		Board	board;
+		// -1 when unknown
+		qint32	minimalPresses{ -1 };
+		QString	source;
+	};
+
+	static const quint16 Version = 1;
+
+	~PuzzlePack() { close(); }
+	bool		open(const QString& filePath, QString& error);
+	void		close();
+	bool		isOpen() const { return _file.isOpen(); }
+	qint32		size() const { return _count; }
+	bool		entry(qint32 index, Entry& entry, QString& error) const;
+
+	static bool	save(const QString& filePath, const std::vector<Entry>& entries, QString& error);
+
+private:
+	MappedFile	_file;
+	qint32		_count{ 0 };
+};
@@ -0,0 +1,171 @@
+#include "rankindex.h"
+#include <algorithm>
+
+void RankIndex::insert(qint32 value)
+{
+	_root = insert(_root, value);
+}
+
+void RankIndex::assign(std::vector<qint32> values)
+{
+	std::sort(values.begin(), values.end());
+	_nodes.clear();
+	for (size_t i = 0; i < values.size(); ++i)
+	{
+		if (_nodes.empty() || _nodes.back().value != values[i])
+		{
+			Node node = { values[i], 0, 0, 0, Nil, Nil };
+			_nodes.push_back(node);
+		}
+		++_nodes.back().count;
+	}
+	_root = build(0, qint32(_nodes.size()), 0);
+}
+
+qint32 RankIndex::countLess(qint32 value) const
+{
+	qint32 res = 0;
+	for (auto node = _root; node != Nil;)
+	{
+		const auto& current = _nodes[node];
+		if (value <= current.value)
+		{
+			node = current.left;
+		}
+		else
+		{
+			res += sizeOf(current.left) + current.count;
+			node = current.right;
+		}
+	}
+	return res;
+}
+
+qint32 RankIndex::countNotGreater(qint32 value) const
+{
+	qint32 res = 0;
+	for (auto node = _root; node != Nil;)
+	{
+		const auto& current = _nodes[node];
+		if (value < current.value)
+		{
+			node = current.left;
+		}
+		else
+		{
+			res += sizeOf(current.left) + current.count;
+			node = current.right;
+		}
+	}
+	return res;
+}
+
+qint32 RankIndex::select(qint32 k) const
+{
+	Q_ASSERT(k >= 0 && k < size());
+	auto node = _root;
+	while (true)
+	{
+		const auto& current = _nodes[node];
+		const auto leftSize = sizeOf(current.left);
+		if (k < leftSize)
+		{
+			node = current.left;
+		}
+		else if (k < leftSize + current.count)
+		{
+			return current.value;
+		}
+		else
+		{
+			k -= leftSize + current.count;
+			node = current.right;
+		}
+	}
+}
+
+void RankIndex::update(qint32 node)
+{
+	auto& current = _nodes[node];
+	current.size = sizeOf(current.left) + current.count + sizeOf(current.right);
+}
+
+qint32 RankIndex::insert(qint32 node, qint32 value)
+{
+	if (node == Nil)
+	{
+		Node leaf = { value, nextPriority(), 1, 1, Nil, Nil };
+		_nodes.push_back(leaf);
+		return qint32(_nodes.size()) - 1;
+	}
+	// equal values share a node, so a player repeating a time does not deepen the tree
+	if (value == _nodes[node].value)
+	{
+		++_nodes[node].count;
+	}
+	else if (value < _nodes[node].value)
+	{
+		const auto left = insert(_nodes[node].left, value);
+		_nodes[node].left = left;
+		if (_nodes[left].priority > _nodes[node].priority)
+		{
+			node = rotateRight(node);
+		}
+	}
+	else
+	{
+		const auto right = insert(_nodes[node].right, value);
+		_nodes[node].right = right;
+		if (_nodes[right].priority > _nodes[node].priority)
+		{
+			node = rotateLeft(node);
+		}
+	}
+	update(node);
+	return node;
+}
+
+qint32 RankIndex::build(qint32 first, qint32 last, qint32 depth)
+{
+	if (first >= last)
+	{
+		return Nil;
+	}
+	// the sorted nodes become a balanced tree, priorities only have to decrease downwards
+	const auto middle = first + (last - first) / 2;
+	auto& node = _nodes[middle];
+	node.priority = depth < 32 ? ~quint32(0) >> depth : 0;
+	node.left = build(first, middle, depth + 1);
+	node.right = build(middle + 1, last, depth + 1);
+	update(middle);
+	return middle;
+}
+
+qint32 RankIndex::rotateLeft(qint32 node)
+{
+	const auto right = _nodes[node].right;
+	_nodes[node].right = _nodes[right].left;
+	_nodes[right].left = node;
+	update(node);
+	update(right);
+	return right;
+}
+
+qint32 RankIndex::rotateRight(qint32 node)
+{
+	const auto left = _nodes[node].left;
+	_nodes[node].left = _nodes[left].right;
+	_nodes[left].right = node;
+	update(node);
+	update(left);
+	return left;
+}
+
+quint32 RankIndex::nextPriority()
+{
+	// xorshift is plenty for treap priorities and keeps the index deterministic
+	_seed ^= _seed << 13;
+	_seed ^= _seed >> 17;
+	_seed ^= _seed << 5;
+	return _seed;
+}
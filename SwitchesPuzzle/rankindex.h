@@ -0,0 +1,47 @@
+#pragma once
+
+#include <QtGlobal>
+#include <vector>
+
+// Order-statistics multiset of times: a treap stored in one node array, every node
+// keeps the number of values in its subtree. Insertion, rank and selection take
+// O(log n) expected time.
+class RankIndex
+{
+public:
+	void		insert(qint32 value);
+	// Replaces the contents by the values, building a balanced tree in O(n log n).
+	void		assign(std::vector<qint32> values);
+	qint32		size() const { return _root == Nil ? 0 : _nodes[_root].size; }
+	// Number of values smaller than value.
+	qint32		countLess(qint32 value) const;
+	// Number of values not greater than value.
+	qint32		countNotGreater(qint32 value) const;
+	// The k-th smallest value, k starts from 0.
+	qint32		select(qint32 k) const;
+
+private:
+	static const qint32 Nil = -1;
+
+	struct Node
+	{
+		qint32	value;
+		quint32	priority;
+		qint32	count;
+		qint32	size;
+		qint32	left;
+		qint32	right;
+	};
+
+	std::vector<Node>	_nodes;
+	qint32				_root{ Nil };
+	quint32				_seed{ 0x9E3779B9u };
+
+	qint32		sizeOf(qint32 node) const { return node == Nil ? 0 : _nodes[node].size; }
+	void		update(qint32 node);
+	qint32		insert(qint32 node, qint32 value);
+	qint32		build(qint32 first, qint32 last, qint32 depth);
+	qint32		rotateLeft(qint32 node);
+	qint32		rotateRight(qint32 node);
+	quint32		nextPriority();
+};
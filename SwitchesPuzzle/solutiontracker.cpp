@@ -0,0 +1,183 @@
+#include "solutiontracker.h"
+#include "solver.h"
+#include <QtAlgorithms>
+#include <algorithm>
+#include <cstdlib>
+
+void SolutionTracker::reset(const Board& board)
+{
+	Board presses;
+	const bool solvable = Solver::solve(board, presses);
+	reset(board, presses);
+	_solvable = solvable;
+}
+
+void SolutionTracker::reset(const Board& board, const Board& presses)
+{
+	const bool evenRows = board.rows() % 2 == 0;
+	const bool evenColumns = board.columns() % 2 == 0;
+	_solvable = true;
+	_presses = presses;
+	_mode = needsSearch(board.rows(), board.columns()) ? Mode::Search : 
+			(evenRows && evenColumns ? Mode::Unique : Mode::FlipColumns);
+	// in the flip mode the lines that may be flipped are always kept as columns
+	_transposed = _mode == Mode::FlipColumns && evenRows;
+	if (_transposed)
+	{
+		_presses = _presses.transposed();
+	}
+	_count = _presses.count();
+	_exact = true;
+	_weights.clear();
+	_penalties.clear();
+	_base = 0;
+	_flips = 0;
+	_minPenalty = 0;
+	if (_mode == Mode::FlipColumns)
+	{
+		const auto rows = _presses.rows();
+		_weights.assign(_presses.columns(), 0);
+		_penalties.assign(rows / 2 + 1, 0);
+		for (qint32 i = 0; i < rows; ++i)
+		{
+			for (qint32 j = 0; j < _presses.columns(); ++j)
+			{
+				_weights[j] += _presses.cell(i, j);
+			}
+		}
+		for (auto weight : _weights)
+		{
+			addWeight(weight);
+		}
+	}
+}
+
+void SolutionTracker::press(qint32 row, qint32 column)
+{
+	if (!_solvable)
+	{
+		return;
+	}
+	if (_transposed)
+	{
+		std::swap(row, column);
+	}
+	const bool pressed = _presses.cell(row, column);
+	_presses.setCell(row, column, !pressed);
+	_count += pressed ? -1 : 1;
+	switch (_mode)
+	{
+	case Mode::FlipColumns:
+		removeWeight(_weights[column]);
+		_weights[column] += pressed ? -1 : 1;
+		addWeight(_weights[column]);
+		break;
+	case Mode::Search:
+		// undoing a press of the minimal solution keeps it minimal
+		_exact = _exact && pressed;
+		break;
+	default:
+		break;
+	}
+}
+
+qint32 SolutionTracker::remainingPresses() const
+{
+	if (!_solvable)
+	{
+		return -1;
+	}
+	switch (_mode)
+	{
+	case Mode::FlipColumns:
+		return _flips % 2 == 0 ? _base : _base + 2 * minPenalty() + 1;
+	case Mode::Search:
+		refresh();
+		return _count;
+	default:
+		return _count;
+	}
+}
+
+bool SolutionTracker::nextPress(qint32& row, qint32& column) const
+{
+	return _solvable && presses().firstCell(row, column);
+}
+
+Board SolutionTracker::presses() const
+{
+	if (!_solvable)
+	{
+		return Board();
+	}
+	refresh();
+	auto res = _presses;
+	if (_mode == Mode::FlipColumns)
+	{
+		const auto rows = res.rows();
+		std::vector<Board::Word> flips(res.wordsPerRow(), 0);
+		qint32 cheapest = -1;
+		for (qint32 j = 0; j < res.columns(); ++j)
+		{
+			if (2 * _weights[j] > rows)
+			{
+				flips[j / Board::WordBits] ^= Board::Word(1) << (j % Board::WordBits);
+			}
+			if (cheapest < 0 && std::abs(rows - 2 * _weights[j]) == 2 * minPenalty() + 1)
+			{
+				cheapest = j;
+			}
+		}
+		if (_flips % 2 != 0)
+		{
+			flips[cheapest / Board::WordBits] ^= Board::Word(1) << (cheapest % Board::WordBits);
+		}
+		for (qint32 i = 0; i < rows; ++i)
+		{
+			auto data = res.rowData(i);
+			for (qint32 j = 0; j < res.wordsPerRow(); ++j)
+			{
+				data[j] ^= flips[j];
+			}
+		}
+	}
+	return _transposed ? res.transposed() : res;
+}
+
+void SolutionTracker::addWeight(qint32 weight)
+{
+	const auto rows = _presses.rows();
+	const auto penalty = std::abs(rows - 2 * weight) / 2;
+	_base += std::min(weight, rows - weight);
+	_flips += 2 * weight > rows;
+	++_penalties[penalty];
+	_minPenalty = std::min(_minPenalty, penalty);
+}
+
+void SolutionTracker::removeWeight(qint32 weight)
+{
+	const auto rows = _presses.rows();
+	_base -= std::min(weight, rows - weight);
+	_flips -= 2 * weight > rows;
+	--_penalties[std::abs(rows - 2 * weight) / 2];
+}
+
+qint32 SolutionTracker::minPenalty() const
+{
+	// the minimum only moves up lazily, each step is paid for by an earlier decrease
+	while (_penalties[_minPenalty] == 0)
+	{
+		++_minPenalty;
+	}
+	return _minPenalty;
+}
+
+void SolutionTracker::refresh() const
+{
+	if (!_exact)
+	{
+		Solver::reduce(_presses);
+		_count = _presses.count();
+		_exact = true;
+	}
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "board.h"
+
+// Keeps a minimal solution of the board up to date while moves are made.
+// A move at (i, j) changes any solution by exactly that press, so every move costs O(1):
+//  - even x even boards have a single solution, the pressed bit is just flipped;
+//  - when one side is odd the solutions differ by an even number of full lines along
+//    the other side, so per line weights and a histogram of their flip costs are kept;
+//  - odd x odd boards stay exact while the pressed switch belongs to the solution
+//    (the hint path), otherwise the solution is reduced again on the next query.
+class SolutionTracker
+{
+public:
+	void		reset(const Board& board);
+	// Starts from a known minimal solution of the board instead of solving it.
+	void		reset(const Board& board, const Board& presses);
+	void		press(qint32 row, qint32 column);
+	bool		isSolvable() const { return _solvable; }
+	qint32		remainingPresses() const;
+	bool		nextPress(qint32& row, qint32& column) const;
+	Board		presses() const;
+	// Odd x odd boards, the only size where a solution is found by a search.
+	static bool	needsSearch(qint32 rows, qint32 columns) { return rows % 2 != 0 && columns % 2 != 0; }
+
+private:
+	enum class Mode
+	{
+		Unique,
+		FlipColumns,
+		Search
+	};
+
+	mutable Board				_presses;
+	std::vector<qint32>			_weights;
+	std::vector<qint32>			_penalties;
+	Mode						_mode{ Mode::Unique };
+	mutable qint32				_count{ 0 };
+	qint32						_base{ 0 };
+	qint32						_flips{ 0 };
+	mutable qint32				_minPenalty{ 0 };
+	bool						_solvable{ false };
+	bool						_transposed{ false };
+	mutable bool				_exact{ true };
+
+	void		addWeight(qint32 weight);
+	void		removeWeight(qint32 weight);
+	qint32		minPenalty() const;
+	void		refresh() const;
+};
@@ -0,0 +1,340 @@
+#include "solver.h"
+#include <QtAlgorithms>
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+
+bool Solver::solve(const Board& board, Board& presses)
+{
+	// the switches that are vertical now have to be flipped
+	presses = Board(board.rows(), board.columns());
+	presses.fill(true);
+	for (qint32 i = 0; i < board.rows(); ++i)
+	{
+		auto data = presses.rowData(i);
+		auto source = board.rowData(i);
+		for (qint32 j = 0; j < board.wordsPerRow(); ++j)
+		{
+			data[j] ^= source[j];
+		}
+	}
+	return solveFlips(presses);
+}
+
+void Solver::reduce(Board& presses)
+{
+	// replace the presses by the switches they flip and solve that again
+	const auto columnsParity = columnParity(presses);
+	for (qint32 i = 0; i < presses.rows(); ++i)
+	{
+		if (rowParity(presses, i))
+		{
+			flipRow(presses, i);
+		}
+	}
+	flipColumns(presses, columnsParity);
+	solveFlips(presses);
+}
+
+bool Solver::solveFlips(Board& presses)
+{
+	const auto rows = presses.rows();
+	const auto columns = presses.columns();
+	const auto words = presses.wordsPerRow();
+	if (rows == 0 || columns == 0)
+	{
+		return true;
+	}
+	auto columnsParity = columnParity(presses);
+	const bool anyColumn = std::any_of(columnsParity.begin(), columnsParity.end(),
+									   [](Board::Word word) { return word != 0; });
+	bool allColumns = true;
+	for (qint32 j = 0; j < words; ++j)
+	{
+		allColumns = allColumns && columnsParity[j] == presses.wordMask(j);
+	}
+	std::vector<bool> rowsParity(rows);
+	bool anyRow = false;
+	bool allRows = true;
+	for (qint32 i = 0; i < rows; ++i)
+	{
+		rowsParity[i] = rowParity(presses, i);
+		anyRow = anyRow || rowsParity[i];
+		allRows = allRows && rowsParity[i];
+	}
+	const bool evenRows = rows % 2 == 0;
+	const bool evenColumns = columns % 2 == 0;
+	if (evenRows && evenColumns)
+	{
+		// the system has full rank: X = b ^ B (x) 1 ^ 1 (x) D
+		for (qint32 i = 0; i < rows; ++i)
+		{
+			if (rowsParity[i])
+			{
+				flipRow(presses, i);
+			}
+		}
+		flipColumns(presses, columnsParity);
+		return true;
+	}
+	if (!evenRows && evenColumns)
+	{
+		// every column parity equals the total number of presses
+		if (anyColumn && !allColumns)
+		{
+			return false;
+		}
+		for (qint32 i = 0; i < rows; ++i)
+		{
+			if (rowsParity[i] != allColumns)
+			{
+				flipRow(presses, i);
+			}
+		}
+		chooseColumns(presses, allColumns);
+		return true;
+	}
+	if (evenRows && !evenColumns)
+	{
+		// every row parity equals the total number of presses
+		if (anyRow && !allRows)
+		{
+			return false;
+		}
+		if (allRows)
+		{
+			for (qint32 j = 0; j < words; ++j)
+			{
+				columnsParity[j] ^= presses.wordMask(j);
+			}
+		}
+		flipColumns(presses, columnsParity);
+		chooseRows(presses, allRows);
+		return true;
+	}
+	// odd x odd: all row and column parities have to match, the rest is free
+	if ((anyRow && !allRows) || allRows != allColumns || (anyColumn && !allColumns))
+	{
+		return false;
+	}
+	if (rows > columns)
+	{
+		auto transposed = presses.transposed();
+		searchRows(transposed, allRows);
+		presses = transposed.transposed();
+	}
+	else
+	{
+		searchRows(presses, allRows);
+	}
+	return true;
+}
+
+void Solver::flipRow(Board& board, qint32 row)
+{
+	auto data = board.rowData(row);
+	for (qint32 j = 0; j < board.wordsPerRow(); ++j)
+	{
+		data[j] ^= board.wordMask(j);
+	}
+}
+
+void Solver::flipColumns(Board& board, const std::vector<Board::Word>& columns)
+{
+	for (qint32 i = 0; i < board.rows(); ++i)
+	{
+		auto data = board.rowData(i);
+		for (qint32 j = 0; j < board.wordsPerRow(); ++j)
+		{
+			data[j] ^= columns[j];
+		}
+	}
+}
+
+bool Solver::rowParity(const Board& board, qint32 row)
+{
+	Board::Word res = 0;
+	auto data = board.rowData(row);
+	for (qint32 j = 0; j < board.wordsPerRow(); ++j)
+	{
+		res ^= data[j];
+	}
+	return qPopulationCount(res) % 2 != 0;
+}
+
+std::vector<Board::Word> Solver::columnParity(const Board& board)
+{
+	std::vector<Board::Word> res(board.wordsPerRow(), 0);
+	for (qint32 i = 0; i < board.rows(); ++i)
+	{
+		auto data = board.rowData(i);
+		for (qint32 j = 0; j < board.wordsPerRow(); ++j)
+		{
+			res[j] ^= data[j];
+		}
+	}
+	return res;
+}
+
+std::vector<qint32> Solver::columnWeights(const Board& board)
+{
+	std::vector<qint32> res(board.columns(), 0);
+	for (qint32 i = 0; i < board.rows(); ++i)
+	{
+		auto data = board.rowData(i);
+		for (qint32 j = 0; j < board.wordsPerRow(); ++j)
+		{
+			for (auto word = data[j]; word != 0; word &= word - 1)
+			{
+				++res[j * Board::WordBits + qCountTrailingZeroBits(word)];
+			}
+		}
+	}
+	return res;
+}
+
+// Flips a set of rows with the given parity that leaves the fewest presses.
+void Solver::chooseRows(Board& presses, bool parity)
+{
+	const auto rows = presses.rows();
+	const auto columns = presses.columns();
+	std::vector<bool> flips(rows);
+	bool flipsParity = false;
+	qint32 cheapest = -1;
+	qint32 cheapestPenalty = std::numeric_limits<qint32>::max();
+	for (qint32 i = 0; i < rows; ++i)
+	{
+		qint32 weight = 0;
+		auto data = presses.rowData(i);
+		for (qint32 j = 0; j < presses.wordsPerRow(); ++j)
+		{
+			weight += qPopulationCount(data[j]);
+		}
+		flips[i] = 2 * weight > columns;
+		flipsParity = flipsParity != flips[i];
+		const auto penalty = std::abs(columns - 2 * weight);
+		if (penalty < cheapestPenalty)
+		{
+			cheapestPenalty = penalty;
+			cheapest = i;
+		}
+	}
+	if (flipsParity != parity && cheapest >= 0)
+	{
+		flips[cheapest] = !flips[cheapest];
+	}
+	for (qint32 i = 0; i < rows; ++i)
+	{
+		if (flips[i])
+		{
+			flipRow(presses, i);
+		}
+	}
+}
+
+// Flips a set of columns with the given parity that leaves the fewest presses.
+void Solver::chooseColumns(Board& presses, bool parity)
+{
+	const auto rows = presses.rows();
+	const auto weights = columnWeights(presses);
+	std::vector<Board::Word> flips(presses.wordsPerRow(), 0);
+	bool flipsParity = false;
+	qint32 cheapest = -1;
+	qint32 cheapestPenalty = std::numeric_limits<qint32>::max();
+	for (qint32 j = 0; j < presses.columns(); ++j)
+	{
+		if (2 * weights[j] > rows)
+		{
+			flips[j / Board::WordBits] ^= Board::Word(1) << (j % Board::WordBits);
+			flipsParity = !flipsParity;
+		}
+		const auto penalty = std::abs(rows - 2 * weights[j]);
+		if (penalty < cheapestPenalty)
+		{
+			cheapestPenalty = penalty;
+			cheapest = j;
+		}
+	}
+	if (flipsParity != parity && cheapest >= 0)
+	{
+		flips[cheapest / Board::WordBits] ^= Board::Word(1) << (cheapest % Board::WordBits);
+	}
+	flipColumns(presses, flips);
+}
+
+// Odd x odd boards: both the row flips and the column flips are free (each with a fixed
+// parity). The rows are enumerated in Gray code order keeping column weights up to date,
+// the best columns for each row set are then picked greedily.
+void Solver::searchRows(Board& presses, bool parity)
+{
+	const auto rows = presses.rows();
+	const auto columns = presses.columns();
+	if (rows > ExhaustiveSearchLimit)
+	{
+		// alternate between the best rows and the best columns until nothing improves,
+		// the first pass fixes the parities, later ones only use even sets
+		chooseRows(presses, parity);
+		chooseColumns(presses, parity);
+		for (;;)
+		{
+			auto candidate = presses;
+			chooseRows(candidate, false);
+			chooseColumns(candidate, false);
+			if (candidate.count() >= presses.count())
+			{
+				break;
+			}
+			presses = candidate;
+		}
+		return;
+	}
+	auto weights = columnWeights(presses);
+	auto cost = [&weights, rows, parity]()
+	{
+		qint32 res = 0;
+		qint32 cheapestPenalty = std::numeric_limits<qint32>::max();
+		bool flipsParity = false;
+		for (auto weight : weights)
+		{
+			res += std::min(weight, rows - weight);
+			flipsParity = flipsParity != (2 * weight > rows);
+			cheapestPenalty = std::min(cheapestPenalty, std::abs(rows - 2 * weight));
+		}
+		return flipsParity != parity ? res + cheapestPenalty : res;
+	};
+	quint32 flips = 0;
+	quint32 bestFlips = 0;
+	qint32 bestCost = std::numeric_limits<qint32>::max();
+	const quint32 combinations = quint32(1) << rows;
+	for (quint32 step = 0; step < combinations; ++step)
+	{
+		if (step != 0)
+		{
+			const auto row = qCountTrailingZeroBits(step);
+			const bool wasFlipped = (flips >> row) & 1;
+			flips ^= quint32(1) << row;
+			for (qint32 j = 0; j < columns; ++j)
+			{
+				weights[j] += (presses.cell(row, j) != wasFlipped) ? -1 : 1;
+			}
+		}
+		if ((qPopulationCount(flips) % 2 != 0) != parity)
+		{
+			continue;
+		}
+		const auto current = cost();
+		if (current < bestCost)
+		{
+			bestCost = current;
+			bestFlips = flips;
+		}
+	}
+	for (qint32 i = 0; i < rows; ++i)
+	{
+		if ((bestFlips >> i) & 1)
+		{
+			flipRow(presses, i);
+		}
+	}
+	chooseColumns(presses, parity);
+}
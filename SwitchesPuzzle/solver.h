@@ -0,0 +1,32 @@
+#pragma once
+
+#include "board.h"
+
+// Finds the smallest set of switches that turns every switch horizontal.
+// A press at (i, j) flips every cell of row i and column j exactly once, so over GF(2)
+// the flipped mask of a press mask X is X ^ R (x) 1 ^ 1 (x) C, where R and C are the
+// row and column parities of X. Eliminating X from this system leaves only row and
+// column flips as free variables, which are then chosen to minimize the number of presses.
+class Solver
+{
+public:
+	// Returns false if the board can not be solved, otherwise presses gets a minimal
+	// press mask (exact when the smaller side of an odd x odd board does not exceed
+	// ExhaustiveSearchLimit, a local optimum otherwise).
+	static bool		solve(const Board& board, Board& presses);
+	// Replaces presses by a minimal press mask with the same effect.
+	static void		reduce(Board& presses);
+
+	static const qint32 ExhaustiveSearchLimit = 20;
+
+private:
+	static bool		solveFlips(Board& presses);
+	static void		flipRow(Board& board, qint32 row);
+	static void		flipColumns(Board& board, const std::vector<Board::Word>& columns);
+	static bool		rowParity(const Board& board, qint32 row);
+	static std::vector<Board::Word> columnParity(const Board& board);
+	static std::vector<qint32> columnWeights(const Board& board);
+	static void		chooseRows(Board& presses, bool parity);
+	static void		chooseColumns(Board& presses, bool parity);
+	static void		searchRows(Board& presses, bool parity);
+};
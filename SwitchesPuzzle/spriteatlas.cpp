@@ -0,0 +1,64 @@
+#include "spriteatlas.h"
+#include <QMap>
+#include <QPainter>
+
+static const qint32 Height = 50;
+static const qint32 Width = 50;
+static const qint32 PictureWidth = 36;
+static const qint32 PictureHeight = 20;
+
+static const QPixmap SwitchPixmap()
+{
+	static QPixmap pixmap(":/SwitchesPuzzle/Resources/thumbler.png");
+	return pixmap;
+}
+
+SpriteAtlas::SpriteAtlas(qreal ratio)
+	: _ratio(ratio)
+{
+	_frames.reserve(FrameCount);
+	for (qint32 i = 0; i < FrameCount; ++i)
+	{
+		QPixmap frame(frameSize() * ratio);
+		frame.setDevicePixelRatio(ratio);
+		frame.fill(Qt::transparent);
+		QPainter painter(&frame);
+		paintRotated(painter, QPoint(0, 0), i * AngleStep);
+		_frames.push_back(frame);
+	}
+}
+
+const QPixmap& SpriteAtlas::frame(qint32 angle) const
+{
+	auto index = (angle / AngleStep) % FrameCount;
+	return _frames[index < 0 ? index + FrameCount : index];
+}
+
+const SpriteAtlas& SpriteAtlas::forRatio(qreal ratio)
+{
+	static QMap<qreal, SpriteAtlas> atlases;
+	auto iter = atlases.find(ratio);
+	if (iter == atlases.end())
+	{
+		iter = atlases.insert(ratio, SpriteAtlas(ratio));
+	}
+	return iter.value();
+}
+
+// Renders the picture through QPainter::rotate(). Used to build the frames and kept
+// as the reference path for the paint benchmark.
+void SpriteAtlas::paintRotated(QPainter& painter, const QPoint& topLeft, qint32 angle)
+{
+	static const QRect rect(-PictureWidth / 2, -PictureHeight / 2, PictureWidth, PictureHeight);
+	painter.save();
+	painter.setRenderHint(QPainter::SmoothPixmapTransform);
+	painter.translate(topLeft.x() + Width / 2, topLeft.y() + Height / 2);
+	painter.rotate(angle);
+	painter.drawPixmap(rect, SwitchPixmap());
+	painter.restore();
+}
+
+QSize SpriteAtlas::frameSize()
+{
+	return QSize(Width, Height);
+}
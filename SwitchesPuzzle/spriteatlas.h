@@ -0,0 +1,28 @@
+#pragma once
+
+#include <QPixmap>
+#include <QVector>
+
+class QPainter;
+
+// The switch picture pre-rendered at every angle the animation can reach, so painting
+// a switch is a plain unscaled blit. Frames are rendered for a given device pixel ratio.
+class SpriteAtlas
+{
+public:
+	static const qint32 AngleStep = 10;
+	static const qint32 FrameCount = 360 / AngleStep;
+
+	SpriteAtlas(qreal ratio = 1);
+	const QPixmap&	frame(qint32 angle) const;
+	qreal			ratio() const { return _ratio; }
+
+	// Atlases are built on the first request for a ratio and kept for the session.
+	static const SpriteAtlas& forRatio(qreal ratio);
+	static void		paintRotated(QPainter& painter, const QPoint& topLeft, qint32 angle);
+	static QSize	frameSize();
+
+private:
+	QVector<QPixmap>	_frames;
+	qreal				_ratio{ 1 };
+};
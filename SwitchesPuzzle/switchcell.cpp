@@ -0,0 +1,25 @@
+#include "switchcell.h"
+#include "spriteatlas.h"
+#include <QPainter>
+
+static const qint32 HighlightRadius = 8;
+static const QColor HighlightColor(255, 200, 0, 120);
+
+void SwitchCell::paint(QPainter& painter, const QPoint& topLeft, const SpriteAtlas& atlas) const
+{
+	if (_highlighted)
+	{
+		painter.save();
+		painter.setRenderHint(QPainter::Antialiasing);
+		painter.setPen(Qt::NoPen);
+		painter.setBrush(HighlightColor);
+		painter.drawRoundedRect(QRect(topLeft, size()), HighlightRadius, HighlightRadius);
+		painter.restore();
+	}
+	painter.drawPixmap(topLeft, atlas.frame(_angle));
+}
+
+QSize SwitchCell::size()
+{
+	return SpriteAtlas::frameSize();
+}
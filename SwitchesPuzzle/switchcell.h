@@ -0,0 +1,26 @@
+#pragma once
+
+#include <QtGlobal>
+
+class QPainter;
+class QPoint;
+class QSize;
+class SpriteAtlas;
+
+// Visual state of a single switch. The switches are painted and hit-tested by
+// SwitchesPuzzle, their rotations are driven by AnimationTimeline.
+class SwitchCell
+{
+public:
+	void		initState(bool horizontal) { _angle = horizontal ? 0 : 90; }
+	qint32		angle() const { return _angle; }
+	void		setAngle(qint32 angle) { _angle = angle; }
+	void		setHighlighted(bool highlighted) { _highlighted = highlighted; }
+	void		paint(QPainter& painter, const QPoint& topLeft, const SpriteAtlas& atlas) const;
+
+	static QSize size();
+
+private:
+	qint16		_angle{ 0 };
+	bool		_highlighted{ false };
+};
@@ -1,42 +1,49 @@
 #include "switchespuzzle.h"
-#include <QGridLayout>
+#include "spriteatlas.h"
+#include "prng.h"
+#include "hintcache.h"
+#include "puzzlegenerator.h"
 #include <QTimer>
-#include "switchwidget.h"
-#include <random>
+#include <QPainter>
+#include <QPaintEvent>
+#include <QMouseEvent>
+#include <QtAlgorithms>
+#include <algorithm>
 
 static const qint32 UpdateInterval = 20;
+static const qint32 Spacing = 15;
+static const qint32 Margin = 11;
 
-SwitchesPuzzle::SwitchesPuzzle(qint32 rows, qint32 columns, QWidget *parent)
+SwitchesPuzzle::SwitchesPuzzle(qint32 rows, qint32 columns, quint64 seed, HintCache* hints, 
+							   QWidget *parent)
 	: QWidget(parent)
+	, _hints(hints)
 	, _rows(rows)
 	, _columns(columns)
 {
 	init();
-	generateRandomInitialState();
+	generateRandomInitialState(seed);
 }
 
-SwitchesPuzzle::SwitchesPuzzle(const QStringList& config, QWidget* parent)
+SwitchesPuzzle::SwitchesPuzzle(const Board& board, HintCache* hints, QWidget* parent)
 	: QWidget(parent)
-	, _rows(config.size())
-	, _columns(config.isEmpty() ? 0 : config.first().size())
+	, _hints(hints)
+	, _rows(board.rows())
+	, _columns(board.columns())
 {
 	init();
-	loadFromConfig(config);
+	loadBoard(board);
 }
 
 void SwitchesPuzzle::activateSwitch(qint32 row, qint32 column)
 {
 	changeStates(row, column);
-	_switches[row][column]->addRotation(-1, -1);
-	update();
-	if (_rotationsNumber == 0)
-	{
-		_timer->start(UpdateInterval);
-	}
+	addRotation(row, column, -1, -1);
 }
 
 void SwitchesPuzzle::undoSwitchActivation(qint32 row, qint32 column)
 {
+	_pendingPresses = Board();
 	accelerate();
 	changeStates(row, column);
 	bool rotationToCenter = false;
@@ -45,35 +52,26 @@ void SwitchesPuzzle::undoSwitchActivation(qint32 row, qint32 column)
 	if (row > 0)
 	{
 		auto destRow = (row == maxDist) ? row : row - 1;
-		_switches[0][column]->addRotation(destRow, column);
-		++_rotationsNumber;
+		addRotation(0, column, destRow, column);
 		rotationToCenter = row == maxDist;
 	}
 	if (row < _rows - 1)
 	{
 		auto destRow = (!rotationToCenter && (_rows - row - 1 == maxDist)) ? row : row + 1;
-		_switches[_rows - 1][column]->addRotation(destRow, column);
-		++_rotationsNumber;
+		addRotation(_rows - 1, column, destRow, column);
 		rotationToCenter = (_rows - row - 1 == maxDist) || rotationToCenter;
 	}
 	if (column > 0)
 	{
 		auto destColumn = (!rotationToCenter && (column == maxDist)) ? column : column - 1;
-		_switches[row][0]->addRotation(row, destColumn);
+		addRotation(row, 0, row, destColumn);
 		rotationToCenter = rotationToCenter || (column == maxDist);
-		++_rotationsNumber;
 	}
 	if (column < _columns - 1)
 	{
 		auto destColumn = (!rotationToCenter && (_columns - column - 1 == maxDist)) ? column : 
 																					  column + 1;
-		_switches[row][_columns - 1]->addRotation(row, destColumn);
-		++_rotationsNumber;
-	}
-	update();
-	if (_rotationsNumber <= 4)
-	{
-		_timer->start(UpdateInterval);
+		addRotation(row, _columns - 1, row, destColumn);
 	}
 }
 
@@ -83,200 +81,349 @@ void SwitchesPuzzle::redoSwitchActivation(qint32 row, qint32 column)
 	activateSwitch(row, column);
 }
 
+// Makes all presses at once. Every switch that ends up changed turns once, together
+// with the others, instead of replaying a wave per press.
+void SwitchesPuzzle::applyPresses(const Board& presses)
+{
+	_pendingPresses = Board();
+	accelerate();
+	setHint(-1, -1);
+	auto changed = _board;
+	_board.applyPresses(presses);
+	changed ^= _board;
+	for (qint32 i = 0; i < _rows; ++i)
+	{
+		auto pressData = presses.rowData(i);
+		auto changedData = changed.rowData(i);
+		for (qint32 j = 0; j < presses.wordsPerRow(); ++j)
+		{
+			for (auto word = pressData[j]; word != 0; word &= word - 1)
+			{
+				_solution.press(i, j * Board::WordBits + qCountTrailingZeroBits(word));
+			}
+			for (auto word = changedData[j]; word != 0; word &= word - 1)
+			{
+				const auto column = j * Board::WordBits + qCountTrailingZeroBits(word);
+				addRotation(i, column, i, column);
+			}
+		}
+	}
+}
+
 void SwitchesPuzzle::switchActivated(qint32 row, qint32 column)
 {
-	if (_rotationsNumber == 0 && !isFinished())
+	if (!_timeline.isRunning() && !isFinished())
 	{
 		emit activated(row, column);
 	}
 }
 
-QStringList SwitchesPuzzle::getConfiguration() const
+bool SwitchesPuzzle::showHint()
 {
-	QStringList res;
-	for (int i = 0; i < _rows; ++i)
+	qint32 row = -1;
+	qint32 column = -1;
+	Board presses;
+	if (_distances ? _distances->nextPress(_board, row, column) : 
+					 solutionPresses(presses) && presses.firstCell(row, column))
 	{
-		QString row;
-		for (int j = 0; j < _columns; ++j)
-		{
-			row.push_back(_switches[i][j]->currentState() == SwitchWidget::SwitchState::Vertical 
-							? '0' : '1');
-		}
-		res.push_back(row);
+		setHint(row, column);
 	}
-	return res;
+	return isSolvable();
 }
 
-void SwitchesPuzzle::rotationFinished(qint32 row, qint32 column, qint32 destRow, qint32 destColumn)
+bool SwitchesPuzzle::playSolution()
 {
-	if (destRow == -1 || destColumn == -1)
+	if (_distances)
 	{
-		if (row > 0)
-		{
-			_switches[row - 1][column]->addRotation(0, column);
-			++_rotationsNumber;
-		}
-		if (row < _rows - 1)
-		{
-			_switches[row + 1][column]->addRotation(_rows - 1, column);
-			++_rotationsNumber;
-		}
-		if (column > 0)
-		{
-			_switches[row][column - 1]->addRotation(row, 0);
-			++_rotationsNumber;
-		}
-		if (column < _columns - 1)
-		{
-			_switches[row][column + 1]->addRotation(row, _columns - 1);
-			++_rotationsNumber;
-		}
+		_distances->solve(_board, _pendingPresses);
 	}
 	else
 	{
-		auto newRow = (destRow == row ? row : (destRow < row ? row - 1 : row + 1));
-		auto newColumn = (destColumn == column ? column : 
-												 (destColumn < column ? column - 1 : column + 1));
-		_switches[newRow][newColumn]->addRotation(destRow, destColumn);
+		solutionPresses(_pendingPresses);
 	}
-	update();
+	if (!_timeline.isRunning())
+	{
+		playNextPress();
+	}
+	return isSolvable();
 }
 
-void SwitchesPuzzle::rotationFinished() 
+bool SwitchesPuzzle::isSolvable() const
 {
-	--_rotationsNumber;
-	if (_rotationsNumber == 0)
-	{
-		_timer->stop();
-		if (isFinished())
-		{
-			emit completed();
-		}
-	}
+	return _distances ? _distances->distance(_board) >= 0 : _solution.isSolvable();
+}
+
+qint32 SwitchesPuzzle::remainingPresses() const
+{
+	return _distances ? _distances->distance(_board) : _solution.remainingPresses();
 }
 
 void SwitchesPuzzle::init()
 {
-	generateWidgets(_rows, _columns);
-	formLayout();
+	_board = Board(_rows, _columns);
+	_cells.resize(_rows * _columns);
+	_timeline.reset(_rows, _columns);
+	_distances = DistanceTable::forSize(_rows, _columns);
+	SpriteAtlas::forRatio(devicePixelRatio());
 	_timer = new QTimer(this);
-	connect(_timer, SIGNAL(timeout()), this, SLOT(update()));
+	connect(_timer, &QTimer::timeout, this, &SwitchesPuzzle::animate);
 	setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Fixed);
 }
 
-void SwitchesPuzzle::generateWidgets(qint32 rows, qint32 columns)
+QSize SwitchesPuzzle::sizeHint() const
+{
+	auto cellSize = SwitchCell::size();
+	return QSize(2 * Margin + _columns * cellSize.width() + std::max(_columns - 1, 0) * Spacing,
+				 2 * Margin + _rows * cellSize.height() + std::max(_rows - 1, 0) * Spacing);
+}
+
+QSize SwitchesPuzzle::minimumSizeHint() const
+{
+	return sizeHint();
+}
+
+void SwitchesPuzzle::paintEvent(QPaintEvent* event)
 {
-	_switches.reserve(rows);
-	for (qint32 i = 0; i < rows; ++i)
+	// a screen change shows up as a new ratio, the atlas for it is rendered once
+	const auto& atlas = SpriteAtlas::forRatio(devicePixelRatio());
+	auto cellSize = SwitchCell::size();
+	const auto stepX = cellSize.width() + Spacing;
+	const auto stepY = cellSize.height() + Spacing;
+	// the region is a union of few rects during an animation, only the cells under them
+	// are visited and every cell is painted once even if it spans several rects
+	std::vector<qint32> cells;
+#if QT_VERSION >= QT_VERSION_CHECK(5, 8, 0)
+	for (const auto& rect : event->region())
+#else
+	for (const auto& rect : event->region().rects())
+#endif
 	{
-		_switches.push_back(QList<SwitchWidget*>());
-		_switches[i].reserve(columns);
-		for (qint32 j = 0; j < columns; ++j)
+		const auto firstRow = std::max((rect.top() - Margin) / stepY, 0);
+		const auto lastRow = std::min((rect.bottom() - Margin) / stepY, _rows - 1);
+		const auto firstColumn = std::max((rect.left() - Margin) / stepX, 0);
+		const auto lastColumn = std::min((rect.right() - Margin) / stepX, _columns - 1);
+		for (qint32 i = firstRow; i <= lastRow; ++i)
 		{
-			_switches[i].push_back(new SwitchWidget(i, j, this));
-			connect(_switches[i][j], SIGNAL(rotationFinished(qint32, qint32, qint32, qint32)),
-					this, SLOT(rotationFinished(qint32, qint32, qint32, qint32)));
-			connect(_switches[i][j], SIGNAL(rotationFinished()),
-					this, SLOT(rotationFinished()));
-			connect(_switches[i][j], SIGNAL(activated(qint32, qint32)),
-					this, SLOT(switchActivated(qint32, qint32)));
+			for (qint32 j = firstColumn; j <= lastColumn; ++j)
+			{
+				if (rect.intersects(cellRect(i, j)))
+				{
+					cells.push_back(i * _columns + j);
+				}
+			}
 		}
 	}
+	std::sort(cells.begin(), cells.end());
+	cells.erase(std::unique(cells.begin(), cells.end()), cells.end());
+	QPainter painter(this);
+	for (auto index : cells)
+	{
+		_cells[index].paint(painter, cellRect(index / _columns, index % _columns).topLeft(), atlas);
+	}
 }
 
-void SwitchesPuzzle::loadFromConfig(const QStringList& config)
+void SwitchesPuzzle::mousePressEvent(QMouseEvent* event)
 {
-	for (int i = 0; i < _rows; ++i)
+	if (event->button() != Qt::LeftButton)
 	{
-		for (int j = 0; j < _columns; ++j)
+		return;
+	}
+	auto cellSize = SwitchCell::size();
+	auto x = event->pos().x() - Margin;
+	auto y = event->pos().y() - Margin;
+	if (x < 0 || y < 0 || x % (cellSize.width() + Spacing) >= cellSize.width() || 
+		y % (cellSize.height() + Spacing) >= cellSize.height())
+	{
+		return;
+	}
+	auto row = y / (cellSize.height() + Spacing);
+	auto column = x / (cellSize.width() + Spacing);
+	if (row < _rows && column < _columns)
+	{
+		switchActivated(row, column);
+	}
+}
+
+void SwitchesPuzzle::animate()
+{
+	// only the switches that have moved are invalidated, idle ones are never repainted
+	_changedCells.clear();
+	const auto running = _timeline.advance(_cells, _changedCells);
+	QRegion dirty;
+	for (auto index : _changedCells)
+	{
+		dirty += cellRect(index / _columns, index % _columns);
+	}
+	if (!dirty.isEmpty())
+	{
+		update(dirty);
+	}
+	if (running)
+	{
+		// the last frame lands exactly at the deadline of the last rotation
+		_timer->setInterval(int(qBound(qint64(1), _timeline.remainingTime(), qint64(UpdateInterval))));
+	}
+	else
+	{
+		_timer->stop();
+		if (isFinished())
 		{
-			SwitchWidget::SwitchState state = config[i][j] == '0' ? 
-											  SwitchWidget::SwitchState::Vertical : 
-											  SwitchWidget::SwitchState::Horizontal;
-			_switches[i][j]->initState(state);
+			emit completed();
+		}
+		else
+		{
+			// the next press restarts the animation, so it must not run inside animate()
+			QTimer::singleShot(0, this, &SwitchesPuzzle::playNextPress);
 		}
 	}
 }
 
-void SwitchesPuzzle::formLayout()
+void SwitchesPuzzle::addRotation(qint32 row, qint32 column, qint32 destRow, qint32 destColumn)
+{
+	_timeline.addRotation(_cells, row, column, destRow, destColumn);
+	if (!_timer->isActive())
+	{
+		_timer->start(UpdateInterval);
+	}
+}
+
+QRect SwitchesPuzzle::cellRect(qint32 row, qint32 column) const
+{
+	auto cellSize = SwitchCell::size();
+	return QRect(QPoint(Margin + column * (cellSize.width() + Spacing), 
+						Margin + row * (cellSize.height() + Spacing)), cellSize);
+}
+
+void SwitchesPuzzle::loadBoard(const Board& board)
+{
+	_board = board;
+	resetSolution();
+	syncAllSwitches();
+}
+
+bool SwitchesPuzzle::isFinished() const
+{
+	return _board.isSolved();
+}
+
+void SwitchesPuzzle::generateRandomInitialState(quint64 seed)
+{
+	// redraws come from the same generator, so the seed still fixes the result
+	Prng generator(seed);
+	_board = PuzzleGenerator::generateRandom(_rows, _columns, generator);
+	resetSolution();
+	syncAllSwitches();
+}
+
+void SwitchesPuzzle::accelerate()
+{
+	_timer->stop();
+	// only the switches the timeline has moved can differ from the board
+	_changedCells.clear();
+	_timeline.clear(_changedCells);
+	if (_changedCells.empty())
+	{
+		return;
+	}
+	QRegion dirty;
+	for (auto index : _changedCells)
+	{
+		const auto row = index / _columns;
+		const auto column = index % _columns;
+		cell(row, column).initState(_board.cell(row, column));
+		dirty += cellRect(row, column);
+	}
+	update(dirty);
+}
+
+void SwitchesPuzzle::changeStates(qint32 row, qint32 column)
+{
+	setHint(-1, -1);
+	// every move, including undo and redo from the history, goes through here
+	_board.toggle(row, column);
+	_solution.press(row, column);
+}
+
+void SwitchesPuzzle::syncAllSwitches()
 {
-	auto mainLayout = new QGridLayout();
 	for (qint32 i = 0; i < _rows; ++i)
 	{
 		for (qint32 j = 0; j < _columns; ++j)
 		{
-			mainLayout->addWidget(_switches[i][j], i, j);
+			cell(i, j).initState(_board.cell(i, j));
 		}
 	}
-	mainLayout->setSpacing(15);
-	setLayout(mainLayout);
 }
 
-bool SwitchesPuzzle::isFinished() const
+void SwitchesPuzzle::setHint(qint32 row, qint32 column)
 {
-	for (auto row : _switches)
+	if (_hintRow >= 0 && _hintColumn >= 0)
 	{
-		for (auto elem : row)
-		{
-			auto res = (elem->currentState() != SwitchWidget::SwitchState::Vertical);
-			if (!res)
-			{
-				return res;
-			}
-		}
+		cell(_hintRow, _hintColumn).setHighlighted(false);
+		update(cellRect(_hintRow, _hintColumn));
+	}
+	_hintRow = row;
+	_hintColumn = column;
+	if (_hintRow >= 0 && _hintColumn >= 0)
+	{
+		cell(_hintRow, _hintColumn).setHighlighted(true);
+		update(cellRect(_hintRow, _hintColumn));
 	}
-	return true;
 }
 
-void SwitchesPuzzle::generateRandomInitialState()
+void SwitchesPuzzle::playNextPress()
 {
-	static std::random_device generator;
-	do 
+	qint32 row = -1;
+	qint32 column = -1;
+	if (_pendingPresses.firstCell(row, column))
 	{
-		for (auto row : _switches)
-		{
-			for (auto elem : row)
-			{
-				if (generator() % 2)
-				{
-					elem->initState(SwitchWidget::SwitchState::Horizontal);
-				}
-				else
-				{
-					elem->initState(SwitchWidget::SwitchState::Vertical);
-				}
-			}
-		}
-	} while (isFinished());
+		_pendingPresses.setCell(row, column, false);
+		emit activated(row, column);
+	}
 }
 
-void SwitchesPuzzle::accelerate()
+void SwitchesPuzzle::resetSolution()
 {
-	_timer->stop();
-	update();
-	for (auto row : _switches)
+	Board presses;
+	if (_distances)
 	{
-		for (auto elem : row)
-		{
-			elem->accelerate();
-		}
+		return;
+	}
+	if (cachesHints() && _hints->find(_board, presses))
+	{
+		_solution.reset(_board, presses);
+		return;
+	}
+	_solution.reset(_board);
+	if (cachesHints() && _solution.isSolvable())
+	{
+		_hints->insert(_board, _solution.presses());
 	}
-	_rotationsNumber = 0;
-	update();
 }
 
-void SwitchesPuzzle::changeStates(qint32 row, qint32 column)
+// The tracker's solution, through the cache: positions met again skip the tracker's
+// reduction on odd x odd boards.
+bool SwitchesPuzzle::solutionPresses(Board& presses)
 {
-	for (qint32 i = 0; i < _rows; ++i)
+	if (cachesHints() && _hints->find(_board, presses))
 	{
-		_switches[i][column]->changeState();
+		return true;
 	}
-	for (qint32 i = 0; i < _columns; ++i)
+	if (!_solution.isSolvable())
 	{
-		if (i == column)
-		{
-			continue;
-		}
-		_switches[row][i]->changeState();
+		presses = Board();
+		return false;
+	}
+	presses = _solution.presses();
+	if (cachesHints())
+	{
+		_hints->insert(_board, presses);
 	}
+	return true;
+}
+
+// Other sizes keep their solution exact in O(1) per move, a lookup would only cost more.
+bool SwitchesPuzzle::cachesHints() const
+{
+	return _hints && SolutionTracker::needsSearch(_rows, _columns);
 }
@@ -1,44 +1,80 @@
 #pragma once
 
 #include <QtWidgets/QMainWindow>
+#include "board.h"
+#include "solutiontracker.h"
+#include "switchcell.h"
+#include "animationtimeline.h"
+#include "distancetable.h"
+#include <vector>
 
 class QTimer;
-class SwitchWidget;
+class HintCache;
 
 class SwitchesPuzzle : public QWidget
 {
 	Q_OBJECT
 
 public:
-	SwitchesPuzzle(qint32 rows, qint32 columns, QWidget* parent = 0);
-	SwitchesPuzzle(const QStringList& config, QWidget* parent = 0);
+	// The hint cache is optional and has to outlive the puzzle.
+	SwitchesPuzzle(qint32 rows, qint32 columns, quint64 seed, HintCache* hints = nullptr, 
+				   QWidget* parent = 0);
+	SwitchesPuzzle(const Board& board, HintCache* hints = nullptr, QWidget* parent = 0);
 	void		undoSwitchActivation(qint32 row, qint32 column);
 	void		redoSwitchActivation(qint32 row, qint32 column);
-	QStringList getConfiguration() const;
+	void		applyPresses(const Board& presses);
+	const Board& board() const { return _board; }
+	bool		showHint();
+	bool		playSolution();
+	bool		isSolvable() const;
+	qint32		remainingPresses() const;
 	qint32		fieldSize() const { return _rows; }
+	qint32		rows() const { return _rows; }
+	qint32		columns() const { return _columns; }
+	QSize		sizeHint() const override;
+	QSize		minimumSizeHint() const override;
 signals:
 	void		completed();
 	void		activated(qint32 row, qint32 column);
 
+protected:
+	void		paintEvent(QPaintEvent* event) override;
+	void		mousePressEvent(QMouseEvent* event) override;
+
 private slots:
-	void		switchActivated(qint32 row, qint32 column);
-	void		rotationFinished(qint32 row, qint32 column, qint32 destRow, qint32 destColumn);
-	void		rotationFinished();
+	void		animate();
+	void		playNextPress();
 
 private:
-	QList<QList<SwitchWidget*>> _switches;
+	std::vector<SwitchCell> _cells;
+	std::vector<qint32> _changedCells;
+	AnimationTimeline _timeline;
+	Board		_board;
+	SolutionTracker _solution;
+	// sizes with a distance table answer from it, the tracker is then left empty
+	const DistanceTable* _distances{ nullptr };
+	HintCache*	_hints{ nullptr };
+	Board		_pendingPresses;
+	qint32		_hintRow{ -1 };
+	qint32		_hintColumn{ -1 };
 	qint32		_rows{ 0 };
 	qint32		_columns{ 0 };
-	qint32		_rotationsNumber{ 0 };
 	QTimer*		 _timer{ nullptr };
 
 	void		activateSwitch(qint32 row, qint32 column);
 	void		init();
-	void		generateWidgets(qint32 rows, qint32 columns);
-	void		formLayout();
+	void		switchActivated(qint32 row, qint32 column);
+	void		addRotation(qint32 row, qint32 column, qint32 destRow, qint32 destColumn);
+	SwitchCell& cell(qint32 row, qint32 column) { return _cells[row * _columns + column]; }
+	QRect		cellRect(qint32 row, qint32 column) const;
 	bool		isFinished() const;
-	void		loadFromConfig(const QStringList& config);
-	void		generateRandomInitialState();
+	void		loadBoard(const Board& board);
+	void		generateRandomInitialState(quint64 seed);
 	void		accelerate();
 	void		changeStates(qint32 row, qint32 column);
+	void		syncAllSwitches();
+	void		setHint(qint32 row, qint32 column);
+	void		resetSolution();
+	bool		solutionPresses(Board& presses);
+	bool		cachesHints() const;
 };